@@ -25,6 +25,8 @@ General Public License for more details.
 #include <string.h>
 #include <unistd.h>
 
+#include <ready.h>
+
 /* Program logic */
 void run(char *line, int line_number);
 
@@ -41,6 +43,7 @@ int main (int argc, char *argv[]) {
      
   install_signal_handler(); 
   parse_argv(argc, argv, &line, &line_number);
+  notify_ready();
 
   run(line, line_number);
 
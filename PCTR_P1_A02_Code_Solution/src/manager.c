@@ -31,6 +31,7 @@ General Public License for more details.
 #include <unistd.h>
 
 #include <definitions.h>
+#include <ready.h>
 
 /* Total number of processes */
 int g_nProcesses;        
@@ -78,13 +79,19 @@ int main(int argc, char *argv[]) {
 void create_processes(const char *filename, const char *pattern) {
   FILE *fp;
   char line[PATH_MAX], line_number_str[3];
-  int line_number = 0;
+  int line_number = 0, ready_fd;
 
   if ((fp = fopen(filename, "r")) == NULL) { 
     fprintf(stderr, "Error opening file %s\n", filename); 
     exit(EXIT_FAILURE); 
   } 
     
+  if ((ready_fd = open_ready_channel()) == -1) {
+    fprintf(stderr, "[MANAGER] Error creating the readiness pipe: %s.\n", strerror(errno));
+    fclose(fp);
+    free_resources();
+    exit(EXIT_FAILURE);
+  }
   while (fgets(line, sizeof(line), fp) != NULL) { 
     sprintf(line_number_str, "%d", line_number);
     create_processes_by_class(PATTERN, 1, line_number * 2, line, line_number_str, pattern);
@@ -93,7 +100,12 @@ void create_processes(const char *filename, const char *pattern) {
   }
 
   printf("[MANAGER] %d processes created.\n", line_number * 2);
-  sleep(1);
+  if (!wait_ready(ready_fd, line_number * 2, READY_TIMEOUT_MS)) {
+    fprintf(stderr, "[MANAGER] Not every process reported ready.\n");
+    terminate_processes();
+    free_resources();
+    exit(EXIT_FAILURE);
+  }
 
   fclose(fp);
 }
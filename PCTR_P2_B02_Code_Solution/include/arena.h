@@ -0,0 +1,57 @@
+/*
+====================================================================
+Concurrent and Real-Time Programming
+Faculty of Computer Science
+University of Castilla-La Mancha (Spain)
+
+Contact info: http://www.libropctr.com
+
+You can redistribute and/or modify this file under the terms of the
+GNU General Public License ad published by the Free Software
+Foundation, either version 3 of the License, or (at your option) and
+later version. See <http://www.gnu.org/licenses/>.
+
+This file is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+====================================================================
+*/
+
+#ifndef __ARENA_H__
+#define __ARENA_H__
+
+/*
+  One shared memory segment per manager instance, holding the task and the
+  data (results included) of the instance. It is pre-faulted with
+  MAP_POPULATE on every mapping, so neither the manager nor the factorers
+  take page faults on first touch.
+
+  Objects are carved out with a bump allocator and referred to by offset
+  (each process maps the arena at a different address). The offsets of the
+  task and the data are kept in the header.
+
+  Include definitions.h before this header.
+*/
+
+#include <stddef.h>
+
+#define ARENA_SIZE      (64 * 1024)
+#define HUGE_PAGE_SIZE  (2 * 1024 * 1024) /* Arena size with ARENA_HUGEPAGES */
+
+struct TArena_t {
+  size_t size;        /* Mapped bytes, header included */
+  size_t used;        /* Bump pointer: offset of the first free byte */
+  size_t task_offset;
+  size_t data_offset;
+} __attribute__((aligned(CACHE_LINE_SIZE)));
+
+struct TArena_t *create_arena (const char *name, size_t size);
+struct TArena_t *attach_arena (const char *name);
+void detach_arena             (struct TArena_t *arena);
+void remove_arena             (const char *name);
+
+size_t arena_alloc            (struct TArena_t *arena, size_t size);
+void *arena_ptr               (struct TArena_t *arena, size_t offset);
+
+#endif
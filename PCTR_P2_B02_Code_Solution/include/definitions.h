@@ -18,32 +18,66 @@ General Public License for more details.
 ====================================================================
 */
 
+/* Prefixes: the actual names end with ".<instance>" (see get_ipc_names()) */
 #define SEM_TASK_READY     "sem_task_ready"
 #define SEM_TASK_READ      "sem_task_read"
 #define SEM_TASK_PROCESSED "sem_task_processed"
-#define SHM_TASK           "shm_task"
-#define SHM_DATA           "shm_data"
+#define SHM_ARENA          "shm_arena"  /* Task and data (see arena.h) */
+
+#define INSTANCE_FLAG      "--instance"
+#define PIN_FLAG           "--pin"      /* Pin factorers to the cores of the data's node */
+#define CHUNK_FLAG         "--chunk"    /* Candidate primes per task: <n> or guided */
+#define MAX_INSTANCE_SIZE  32
+#define IPC_NAME_SIZE      64
 
 #define FACTORER_CLASS     "FACTORER"
 #define FACTORER_PATH      "./exec/factorer"
+#define FACTORER_LOOP_FLAG "--loop"   /* Serve tasks until STOP_TASK */
+#define DAEMON_FLAG        "--daemon" /* Manager as a long-running service */
 
 #define N_PRIME_NUMBERS      101
+#define STOP_TASK           -1   /* first_position telling a looping worker to finish */
+#define CHUNK_GUIDED         0   /* Chunk size policy: decreasing chunks (OpenMP guided) */
+
+#define TRUE 1
+#define FALSE 0
+#define CACHE_LINE_SIZE      64
+
+/* Result written by a single factorer. Each one fills a whole cache line,
+   so factorers running on different cores never write to the same line */
+struct TResult_t {
+  int numerator_exponent;
+  int denominator_exponent;
+} __attribute__((aligned(CACHE_LINE_SIZE)));
 
 struct TData_t {
   /* Numerator/denominator to factor */
   int numerator;
   int denominator;
+  /* Part of the numerator/denominator not factored yet (atomic updates) */
+  int numerator_cofactor;
+  int denominator_cofactor;
   /* Exponents for each prime number of the numerator */
   int numerator_exponents[N_PRIME_NUMBERS];
   /* Exponents for each prime number of the denominator */
   int denominator_exponents[N_PRIME_NUMBERS];
+  /* Private slot of each task (merged by the manager at the end) */
+  struct TResult_t results[N_PRIME_NUMBERS];
 };
 
 struct TTask_t {
-  /* Actual value of the prime number*/
-  int prime_number;
-  /* Position of the prime number within the list */
-  int prime_number_position;
+  /* Range [first, last) of prime positions within the list */
+  int first_position;
+  int last_position;
+};
+
+/* Names of the IPC objects of one manager instance */
+struct TIpcNames_t {
+  char instance[MAX_INSTANCE_SIZE];
+  char sem_task_ready[IPC_NAME_SIZE];
+  char sem_task_read[IPC_NAME_SIZE];
+  char sem_task_processed[IPC_NAME_SIZE];
+  char shm_arena[IPC_NAME_SIZE];
 };
 
 enum ProcessClass_t {FACTORER}; 
@@ -0,0 +1,52 @@
+/*
+====================================================================
+Concurrent and Real-Time Programming
+Faculty of Computer Science
+University of Castilla-La Mancha (Spain)
+
+Contact info: http://www.libropctr.com
+
+You can redistribute and/or modify this file under the terms of the
+GNU General Public License ad published by the Free Software
+Foundation, either version 3 of the License, or (at your option) and
+later version. See <http://www.gnu.org/licenses/>.
+
+This file is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+====================================================================
+*/
+
+#ifndef __DIVISIBILITY_H__
+#define __DIVISIBILITY_H__
+
+/*
+  Division-free divisibility tests (Granlund-Montgomery).
+
+  For an odd prime p with inverse p' modulo 2^32, n is a multiple of p iff
+  n * p' <= (2^32 - 1) / p, and in that case n * p' is exactly n / p.
+  The table keeps p' and the limit of every prime in separate arrays
+  (SoA) so that a whole block of primes is tested with vector operations.
+*/
+
+#define DIV_BLOCK        4   /* Primes per vector (one SSE2/NEON register) */
+#define MAX_DIV_PRIMES   128 /* Table capacity (multiple of DIV_BLOCK) */
+
+struct TDivisibilityTable_t {
+  int n_primes;
+  int two_position; /* Position of 2 in the table (-1 if absent) */
+  unsigned int primes[MAX_DIV_PRIMES] __attribute__((aligned(32)));
+  unsigned int inverses[MAX_DIV_PRIMES] __attribute__((aligned(32)));
+  unsigned int limits[MAX_DIV_PRIMES] __attribute__((aligned(32)));
+};
+
+void init_divisibility_table (struct TDivisibilityTable_t *table, const int *primes, int n_primes);
+int find_prime_divisors      (const struct TDivisibilityTable_t *table, unsigned int number, int *positions);
+unsigned int modular_inverse (unsigned int odd);
+int multiplicity             (const struct TDivisibilityTable_t *table, int position,
+			      unsigned int number, unsigned int *quotient);
+int exact_divide             (const struct TDivisibilityTable_t *table, int position, int number, int times);
+unsigned int magnitude       (int number);
+
+#endif
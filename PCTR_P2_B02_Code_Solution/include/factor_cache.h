@@ -0,0 +1,77 @@
+/*
+====================================================================
+Concurrent and Real-Time Programming
+Faculty of Computer Science
+University of Castilla-La Mancha (Spain)
+
+Contact info: http://www.libropctr.com
+
+You can redistribute and/or modify this file under the terms of the
+GNU General Public License ad published by the Free Software
+Foundation, either version 3 of the License, or (at your option) and
+later version. See <http://www.gnu.org/licenses/>.
+
+This file is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+====================================================================
+*/
+
+#ifndef __FACTOR_CACHE_H__
+#define __FACTOR_CACHE_H__
+
+/*
+  Factorization cache shared by every run on the host (it is never removed
+  by the manager; make clean_cache drops it).
+
+  Open-addressing table of number -> sparse exponent vector. Readers never
+  lock: every entry is guarded by a sequence counter (odd while a writer is
+  updating it). When a probe window is full, CLOCK (second chance) picks
+  the victim among its entries.
+
+  The segment starts with a header (magic, layout version and sizes): a
+  segment left by a build with another layout is reinitialized on attach
+  instead of being read as valid.
+*/
+
+#define SHM_FACTOR_CACHE    "shm_factor_cache"
+#define CACHE_BITS          12
+#define CACHE_SLOTS         (1 << CACHE_BITS)
+#define CACHE_PROBES        8
+#define MAX_CACHED_FACTORS  10 /* Distinct prime factors of a 32-bit number */
+#define CACHE_MAGIC         0x46434348u /* "FCCH" */
+#define CACHE_VERSION       1           /* Bump on any change of the layout */
+
+/* Sparse exponent vector (positions refer to g_primes) */
+struct TFactors_t {
+  int n_factors;
+  unsigned char positions[MAX_CACHED_FACTORS];
+  unsigned char exponents[MAX_CACHED_FACTORS];
+};
+
+struct TCacheEntry_t {
+  unsigned int sequence; /* 0: never used; odd: being written */
+  int referenced;        /* CLOCK bit, set on every hit */
+  int number;
+  struct TFactors_t factors;
+};
+
+struct TCacheHeader_t {
+  unsigned int magic;      /* CACHE_MAGIC once initialized */
+  unsigned int version;    /* CACHE_VERSION */
+  unsigned int n_slots;    /* CACHE_SLOTS */
+  unsigned int entry_size; /* sizeof(struct TCacheEntry_t) */
+};
+
+struct TFactorCache_t {
+  struct TCacheHeader_t header;
+  struct TCacheEntry_t entries[CACHE_SLOTS];
+};
+
+struct TFactorCache_t *open_factor_cache (void);
+void close_factor_cache                  (struct TFactorCache_t *cache);
+int lookup_factors                       (struct TFactorCache_t *cache, int number, struct TFactors_t *factors);
+void store_factors                       (struct TFactorCache_t *cache, int number, const struct TFactors_t *factors);
+
+#endif
@@ -0,0 +1,40 @@
+/*
+====================================================================
+Concurrent and Real-Time Programming
+Faculty of Computer Science
+University of Castilla-La Mancha (Spain)
+
+Contact info: http://www.libropctr.com
+
+You can redistribute and/or modify this file under the terms of the
+GNU General Public License ad published by the Free Software
+Foundation, either version 3 of the License, or (at your option) and
+later version. See <http://www.gnu.org/licenses/>.
+
+This file is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+====================================================================
+*/
+
+#ifndef __PLACEMENT_H__
+#define __PLACEMENT_H__
+
+/*
+  Optional CPU placement of the factorers. Every factorer is pinned to one
+  core, round-robin over the cores of the NUMA node that holds the shared
+  data, so the workers neither migrate nor touch it from a remote socket.
+  The NUMA topology is read from sysfs (no libnuma needed); without it,
+  the whole machine counts as node 0.
+*/
+
+#include <sys/types.h>
+
+#define MAX_PLACEMENT_CPUS 1024
+
+int get_memory_node (void *address);
+int get_node_cpus   (int node, int *cpus, int max_cpus);
+int pin_process     (pid_t pid, int cpu);
+
+#endif
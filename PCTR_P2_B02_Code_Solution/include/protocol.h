@@ -0,0 +1,57 @@
+/*
+====================================================================
+Concurrent and Real-Time Programming
+Faculty of Computer Science
+University of Castilla-La Mancha (Spain)
+
+Contact info: http://www.libropctr.com
+
+You can redistribute and/or modify this file under the terms of the
+GNU General Public License ad published by the Free Software
+Foundation, either version 3 of the License, or (at your option) and
+later version. See <http://www.gnu.org/licenses/>.
+
+This file is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+====================================================================
+*/
+
+#ifndef __PROTOCOL_H__
+#define __PROTOCOL_H__
+
+#include <stddef.h>
+
+/*
+  Binary protocol of the factoring service (./exec/manager --daemon).
+  Every request is a TRequest_t; every reply is a TReplyHeader_t followed
+  by n_factors TReplyFactor_t. A connection may carry any number of
+  requests, served in order.
+*/
+
+#define FACTOR_SOCKET      "/tmp/pctr_factorer.sock"
+#define MAX_REPLY_FACTORS  N_PRIME_NUMBERS
+
+#define REPLY_OK           0
+#define REPLY_BAD_REQUEST  1
+
+struct TRequest_t {
+  int numerator;
+  int denominator;
+};
+
+struct TReplyHeader_t {
+  int status;
+  int n_factors;
+};
+
+struct TReplyFactor_t {
+  unsigned short prime;
+  short exponent;        /* > 0: numerator; < 0: denominator */
+};
+
+int read_full  (int fd, void *buffer, size_t size);
+int write_full (int fd, const void *buffer, size_t size);
+
+#endif
@@ -0,0 +1,63 @@
+/*
+====================================================================
+Concurrent and Real-Time Programming
+Faculty of Computer Science
+University of Castilla-La Mancha (Spain)
+
+Contact info: http://www.libropctr.com
+
+You can redistribute and/or modify this file under the terms of the
+GNU General Public License ad published by the Free Software
+Foundation, either version 3 of the License, or (at your option) and
+later version. See <http://www.gnu.org/licenses/>.
+
+This file is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+====================================================================
+*/
+
+#ifndef __REMOTE_H__
+#define __REMOTE_H__
+
+/*
+  TCP transport of the distributed mode (./exec/coordinator and
+  ./exec/remote_worker). Workers connect to the coordinator, which keeps
+  at most one TRemoteTask_t in flight per worker and gets a
+  TRemoteResult_t back for each. Every field travels in network byte
+  order. Closing the connection releases the worker.
+
+  Include after definitions.h.
+*/
+
+#define REMOTE_PORT         "5555"
+#define MAX_REMOTE_WORKERS  64
+#define MAX_TASK_ATTEMPTS   3  /* Dispatches of one task (worker losses) before giving up */
+
+/* Fault injection of ./exec/remote_worker (make test_distributed) */
+#define DROP_PRIME_FLAG     "--drop-prime" /* <p>: hang up when given a task of prime p */
+#define DELAY_FLAG          "--delay"      /* <ms>: sleep before every result (slow worker) */
+
+/* The whole fraction and the prime travel with the task: workers share
+   no memory and have no prime table. Remote tasks hold a single prime */
+struct TRemoteTask_t {
+  int numerator;
+  int denominator;
+  int prime_number;
+  struct TTask_t task;
+};
+
+/* Raw exponents of the task prime in each side (as in TResult_t) */
+struct TRemoteResult_t {
+  int prime_number_position;
+  int numerator_exponent;
+  int denominator_exponent;
+};
+
+int send_remote_task      (int fd, const struct TRemoteTask_t *task);
+int receive_remote_task   (int fd, struct TRemoteTask_t *task);
+int send_remote_result    (int fd, const struct TRemoteResult_t *result);
+int receive_remote_result (int fd, struct TRemoteResult_t *result);
+
+#endif
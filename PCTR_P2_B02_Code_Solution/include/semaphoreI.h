@@ -23,10 +23,22 @@ General Public License for more details.
 
 #include <semaphore.h>
 
+/* Implemented by semaphoreI.c (named POSIX semaphores, default) or by
+   semaphoreI_futex.c (make SEM_BACKEND=futex) */
+
 sem_t *create_semaphore (const char *name, unsigned int value);
 sem_t *get_semaphore    (const char *name);
 void remove_semaphore   (const char *name);
 void signal_semaphore   (sem_t *sem);
 void wait_semaphore     (sem_t *sem);
 
+/* Unnamed semaphores shared by the threads of a single process */
+sem_t *create_private_semaphore (unsigned int value);
+void remove_private_semaphore   (sem_t *sem);
+
+/* Wait-time statistics (only collected with make SEM_STATS=1) */
+void name_semaphore_stats   (const char *instance);
+void print_semaphore_stats  ();
+void remove_semaphore_stats ();
+
 #endif
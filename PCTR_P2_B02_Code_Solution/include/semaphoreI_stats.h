@@ -0,0 +1,55 @@
+/*
+====================================================================
+Concurrent and Real-Time Programming
+Faculty of Computer Science
+University of Castilla-La Mancha (Spain)
+
+Contact info: http://www.libropctr.com
+
+You can redistribute and/or modify this file under the terms of the
+GNU General Public License ad published by the Free Software
+Foundation, either version 3 of the License, or (at your option) and
+later version. See <http://www.gnu.org/licenses/>.
+
+This file is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+====================================================================
+*/
+
+#ifndef __SEMAPHOREI_STATS_H__
+#define __SEMAPHOREI_STATS_H__
+
+#include <semaphore.h>
+
+/* Hooks used by the semaphoreI backends. They only record anything when
+   compiled with -DSEMAPHOREI_STATS (make SEM_STATS=1) */
+
+#define SHM_SEM_STATS      "shm_sem_stats"
+#define MAX_SEM_STATS      16
+#define SEM_STATS_NAME     64
+#define SEM_STATS_BUCKETS  32
+
+/* Claiming a slot: CAS of 'used' from 0 to -1, clear of every field from
+   'name' on, then 'used' = 1 published (release) */
+struct TSemStats_t {
+  int used;                                 /* 0: free, -1: being written, 1: claimed */
+  char name[SEM_STATS_NAME];                /* Semaphore name */
+  unsigned long n_waits;                    /* Calls to wait_semaphore() */
+  unsigned long total_ns;                   /* Total time blocked */
+  unsigned long max_ns;                     /* Longest single wait */
+  unsigned long histogram[SEM_STATS_BUCKETS]; /* Waits by floor(log2(ns)) */
+};
+
+#ifdef SEMAPHOREI_STATS
+long long stats_now(void);
+void stats_register(const char *name, sem_t *sem, int create);
+void stats_record_wait(sem_t *sem, long long start_ns);
+#else
+#define stats_now() 0
+#define stats_register(name, sem, create)
+#define stats_record_wait(sem, start_ns) ((void)(start_ns))
+#endif
+
+#endif
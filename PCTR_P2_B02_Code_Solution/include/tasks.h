@@ -0,0 +1,74 @@
+/*
+====================================================================
+Concurrent and Real-Time Programming
+Faculty of Computer Science
+University of Castilla-La Mancha (Spain)
+
+Contact info: http://www.libropctr.com
+
+You can redistribute and/or modify this file under the terms of the
+GNU General Public License ad published by the Free Software
+Foundation, either version 3 of the License, or (at your option) and
+later version. See <http://www.gnu.org/licenses/>.
+
+This file is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+====================================================================
+*/
+
+#ifndef __TASKS_H__
+#define __TASKS_H__
+
+#include <semaphore.h>
+
+/* Task logic shared by every factoring engine (processes or threads).
+   Include after definitions.h */
+
+struct TFactorCache_t;
+struct TDivisibilityTable_t;
+
+/* Sides of the fraction found in the factor cache */
+#define CACHED_NUMERATOR   1
+#define CACHED_DENOMINATOR 2
+
+/* First n prime numbers */
+extern int g_primes[N_PRIME_NUMBERS];
+/* Inverses and limits of g_primes, built once per process */
+extern struct TDivisibilityTable_t g_divisibility;
+/* Print progress messages (TRUE by default) */
+extern int g_verbose;
+/* Candidate primes per task: a fixed size or CHUNK_GUIDED (default) */
+extern int g_chunk_size;
+
+/* IPC naming */
+int get_ipc_names           (const char *instance, struct TIpcNames_t *names);
+
+/* Manager side */
+int factor_fraction         (sem_t *sem_task_ready, sem_t *sem_task_read, sem_t *sem_task_processed,
+			     struct TFactorCache_t *cache, struct TData_t *data, struct TTask_t *task,
+			     int numerator, int denominator);
+/* factor_fraction() in two steps, to size the workers in between */
+int prepare_fraction        (struct TFactorCache_t *cache, struct TData_t *data, int numerator, int denominator);
+int count_tasks             (struct TData_t *data, int n_tasks);
+int complete_fraction       (sem_t *sem_task_ready, sem_t *sem_task_read, sem_t *sem_task_processed,
+			     struct TFactorCache_t *cache, struct TData_t *data, struct TTask_t *task, int cached);
+int get_pool_size          ();
+void init_data              (struct TData_t *data, int numerator, int denominator, int n_prime_numbers);
+int notify_tasks            (sem_t *sem_task_ready, sem_t *sem_task_read,
+			     struct TData_t *data, struct TTask_t *task, int n_tasks);
+void notify_stop            (sem_t *sem_task_ready, sem_t *sem_task_read, struct TTask_t *task, int n_workers);
+void wait_tasks_termination (sem_t *sem_task_processed, int n_tasks);
+void add_remaining_cofactors(struct TData_t *data);
+int apply_cached_factors    (struct TFactorCache_t *cache, struct TData_t *data);
+void cache_computed_factors (struct TFactorCache_t *cache, struct TData_t *data, int cached);
+void merge_results          (struct TData_t *data, int n_tasks);
+void print_result           (struct TData_t *data);
+
+/* Worker side */
+int get_and_process_task    (sem_t *sem_task_ready, sem_t *sem_task_read,
+			     struct TData_t *data, const struct TTask_t *task);
+void notify_task_completed  (sem_t *sem_task_processed);
+
+#endif
@@ -0,0 +1,136 @@
+/*
+====================================================================
+Concurrent and Real-Time Programming
+Faculty of Computer Science
+University of Castilla-La Mancha (Spain)
+
+Contact info: http://www.libropctr.com
+
+You can redistribute and/or modify this file under the terms of the
+GNU General Public License ad published by the Free Software
+Foundation, either version 3 of the License, or (at your option) and
+later version. See <http://www.gnu.org/licenses/>.
+
+This file is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+====================================================================
+*/
+
+#define _DEFAULT_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <definitions.h>
+#include <arena.h>
+
+/* Auxiliar functions */
+struct TArena_t *map_arena(int fd, size_t size);
+
+struct TArena_t *create_arena(const char *name, size_t size) {
+  struct TArena_t *arena;
+  int fd;
+
+#ifdef ARENA_HUGEPAGES
+  /* Transparent huge pages back whole 2 MiB extents only */
+  size = (size + HUGE_PAGE_SIZE - 1) & ~((size_t)HUGE_PAGE_SIZE - 1);
+#endif
+
+  if ((fd = shm_open(name, O_CREAT | O_RDWR, 0644)) == -1 ||
+      ftruncate(fd, size) == -1) {
+    fprintf(stderr, "Error creating arena %s: %s.\n", name, strerror(errno));
+    if (fd != -1) {
+      close(fd);
+    }
+    return NULL;
+  }
+
+  if ((arena = map_arena(fd, size)) != NULL) {
+    arena->size = size;
+    arena->used = sizeof(struct TArena_t);
+  }
+
+  return arena;
+}
+
+struct TArena_t *attach_arena(const char *name) {
+  struct stat info;
+  int fd;
+
+  if ((fd = shm_open(name, O_RDWR, 0644)) == -1 || fstat(fd, &info) == -1) {
+    fprintf(stderr, "Error opening arena %s: %s.\n", name, strerror(errno));
+    if (fd != -1) {
+      close(fd);
+    }
+    return NULL;
+  }
+
+  return map_arena(fd, info.st_size);
+}
+
+void detach_arena(struct TArena_t *arena) {
+  munmap(arena, arena->size);
+}
+
+void remove_arena(const char *name) {
+  shm_unlink(name);
+}
+
+size_t arena_alloc(struct TArena_t *arena, size_t size) {
+  size_t offset, next;
+
+  /* Every object starts on its own cache line */
+  size = (size + CACHE_LINE_SIZE - 1) & ~((size_t)CACHE_LINE_SIZE - 1);
+
+  offset = __atomic_load_n(&arena->used, __ATOMIC_RELAXED);
+  do {
+    next = offset + size;
+    if (next > arena->size) {
+      return 0; /* Offset 0 is the header: never a valid object */
+    }
+  } while (!__atomic_compare_exchange_n(&arena->used, &offset, next, 0,
+					__ATOMIC_RELAXED, __ATOMIC_RELAXED));
+
+  return offset;
+}
+
+void *arena_ptr(struct TArena_t *arena, size_t offset) {
+  return (char *)arena + offset;
+}
+
+/******************** Auxiliar functions ********************/
+
+struct TArena_t *map_arena(int fd, size_t size) {
+  void *arena;
+#ifdef ARENA_HUGEPAGES
+  volatile char *page;
+  size_t i;
+
+  /* The hint must precede the first fault, so no MAP_POPULATE here */
+  arena = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+#else
+  arena = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, 0);
+#endif
+  close(fd);
+  if (arena == MAP_FAILED) {
+    fprintf(stderr, "Error mapping arena: %s.\n", strerror(errno));
+    return NULL;
+  }
+
+#ifdef ARENA_HUGEPAGES
+  /* Honoured when shmem THP is in 'advise' mode or above; then pre-fault */
+  madvise(arena, size, MADV_HUGEPAGE);
+  for (page = arena, i = 0; i < size; i += sysconf(_SC_PAGESIZE)) {
+    (void)page[i];
+  }
+#endif
+
+  return arena;
+}
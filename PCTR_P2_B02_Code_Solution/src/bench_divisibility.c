@@ -0,0 +1,140 @@
+/*
+====================================================================
+Concurrent and Real-Time Programming
+Faculty of Computer Science
+University of Castilla-La Mancha (Spain)
+
+Contact info: http://www.libropctr.com
+
+You can redistribute and/or modify this file under the terms of the
+GNU General Public License ad published by the Free Software
+Foundation, either version 3 of the License, or (at your option) and
+later version. See <http://www.gnu.org/licenses/>.
+
+This file is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+====================================================================
+*/
+
+#define _DEFAULT_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <definitions.h>
+#include <divisibility.h>
+
+#define DEFAULT_N_NUMBERS 200000
+
+/* Same table as the manager */
+int g_primes[] = {
+  2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47, 53, 59, 61, 67,
+  71, 73, 79, 83, 89, 97, 101, 103, 107, 109, 113, 127, 131, 137, 139, 149, 151, 157,
+  163, 167, 173, 179, 181, 191, 193, 197, 199, 211, 223, 227, 229, 233, 239, 241, 251,
+  257, 263, 269, 271, 277, 281, 283, 293, 307, 311, 313, 317, 331, 337, 347, 349, 353,
+  359, 367, 373, 379, 383, 389, 397, 401, 409, 419, 421, 431, 433, 439, 443, 449, 457,
+  461, 463, 467, 479, 487, 491, 499, 503, 509, 521, 523, 541, 547
+};
+
+/* Kernels under test: both return the sum of all exponents */
+long scalar_sweep(unsigned int number);
+long vector_sweep(const struct TDivisibilityTable_t *table, unsigned int number);
+
+/* Auxiliar functions */
+double elapsed_seconds(const struct timespec *start, const struct timespec *end);
+
+/******************** Main function ********************/
+
+int main(int argc, char *argv[]) {
+  struct TDivisibilityTable_t table;
+  struct timespec start, end;
+  unsigned int *numbers;
+  long i, n_numbers, scalar_sum = 0, vector_sum = 0;
+  double t_scalar, t_vector;
+
+  n_numbers = (argc > 1) ? atol(argv[1]) : DEFAULT_N_NUMBERS;
+  if ((numbers = malloc(n_numbers * sizeof(unsigned int))) == NULL) {
+    perror("malloc");
+    exit(EXIT_FAILURE);
+  }
+
+  /* Random 32-bit inputs (a third of them rich in small factors) */
+  srandom(1);
+  for (i = 0; i < n_numbers; i++) {
+    numbers[i] = ((unsigned int)random() << 1) ^ (unsigned int)random();
+    if (i % 3 == 0) {
+      numbers[i] = (numbers[i] % 1000 + 1) * 2 * 3 * 5 * 7 * 11;
+    }
+    if (numbers[i] == 0) {
+      numbers[i] = 1;
+    }
+  }
+
+  init_divisibility_table(&table, g_primes, N_PRIME_NUMBERS);
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (i = 0; i < n_numbers; i++) {
+    scalar_sum += scalar_sweep(numbers[i]);
+  }
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  t_scalar = elapsed_seconds(&start, &end);
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (i = 0; i < n_numbers; i++) {
+    vector_sum += vector_sweep(&table, numbers[i]);
+  }
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  t_vector = elapsed_seconds(&start, &end);
+
+  if (scalar_sum != vector_sum) {
+    fprintf(stderr, "Kernels disagree: %ld vs %ld\n", scalar_sum, vector_sum);
+    exit(EXIT_FAILURE);
+  }
+
+  printf("kernel,numbers,ns_per_number\n");
+  printf("scalar,%ld,%.1f\n", n_numbers, t_scalar * 1e9 / n_numbers);
+  printf("vector,%ld,%.1f\n", n_numbers, t_vector * 1e9 / n_numbers);
+
+  free(numbers);
+  return EXIT_SUCCESS;
+}
+
+/******************** Kernels ********************/
+
+long scalar_sweep(unsigned int number) {
+  unsigned int n;
+  long total = 0;
+  int i;
+
+  /* Former how_many_times_divisible() applied to every prime */
+  for (i = 0; i < N_PRIME_NUMBERS; i++) {
+    for (n = number; !(n % g_primes[i]); n /= g_primes[i]) {
+      total++;
+    }
+  }
+
+  return total;
+}
+
+long vector_sweep(const struct TDivisibilityTable_t *table, unsigned int number) {
+  int positions[N_PRIME_NUMBERS];
+  unsigned int quotient;
+  int i, n_positions;
+  long total = 0;
+
+  n_positions = find_prime_divisors(table, number, positions);
+  for (i = 0; i < n_positions; i++) {
+    total += multiplicity(table, positions[i], number, &quotient);
+  }
+
+  return total;
+}
+
+/******************** Auxiliar functions ********************/
+
+double elapsed_seconds(const struct timespec *start, const struct timespec *end) {
+  return (end->tv_sec - start->tv_sec) + (end->tv_nsec - start->tv_nsec) / 1e9;
+}
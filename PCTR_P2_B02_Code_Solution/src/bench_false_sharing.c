@@ -0,0 +1,149 @@
+/*
+====================================================================
+Concurrent and Real-Time Programming
+Faculty of Computer Science
+University of Castilla-La Mancha (Spain)
+
+Contact info: http://www.libropctr.com
+
+You can redistribute and/or modify this file under the terms of the
+GNU General Public License ad published by the Free Software
+Foundation, either version 3 of the License, or (at your option) and
+later version. See <http://www.gnu.org/licenses/>.
+
+This file is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+====================================================================
+*/
+
+#define _DEFAULT_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <definitions.h>
+
+#define DEFAULT_MAX_WRITERS 16
+#define DEFAULT_ITERATIONS  10000000
+
+/* Old layout: neighbouring exponents share cache lines */
+struct TPacked_t {
+  int numerator_exponents[N_PRIME_NUMBERS];
+  int denominator_exponents[N_PRIME_NUMBERS];
+};
+
+/* New layout: one cache line per writer */
+struct TPadded_t {
+  struct TResult_t results[N_PRIME_NUMBERS];
+};
+
+/* Benchmark */
+double run_writers(int n_writers, long iterations, int padded);
+void write_slot(void *area, int slot, long iterations, int padded);
+
+/* Auxiliar functions */
+double elapsed_seconds(const struct timespec *start, const struct timespec *end);
+void parse_argv(int argc, char *argv[], int *max_writers, long *iterations);
+
+/******************** Main function ********************/
+
+int main(int argc, char *argv[]) {
+  int n_writers, max_writers;
+  long iterations;
+  double t_packed, t_padded;
+
+  parse_argv(argc, argv, &max_writers, &iterations);
+
+  printf("writers,packed_s,padded_s,speedup\n");
+  for (n_writers = 1; n_writers <= max_writers; n_writers *= 2) {
+    t_packed = run_writers(n_writers, iterations, 0);
+    t_padded = run_writers(n_writers, iterations, 1);
+    printf("%d,%.4f,%.4f,%.2f\n", n_writers, t_packed, t_padded, t_packed / t_padded);
+  }
+
+  return EXIT_SUCCESS;
+}
+
+/******************** Benchmark ********************/
+
+double run_writers(int n_writers, long iterations, int padded) {
+  struct timespec start, end;
+  size_t size;
+  void *area;
+  int i;
+
+  size = padded ? sizeof(struct TPadded_t) : sizeof(struct TPacked_t);
+  area = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if (area == MAP_FAILED) {
+    perror("mmap");
+    exit(EXIT_FAILURE);
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (i = 0; i < n_writers; i++) {
+    switch (fork()) {
+    case -1:
+      perror("fork");
+      exit(EXIT_FAILURE);
+    case 0:
+      write_slot(area, i, iterations, padded);
+      _exit(EXIT_SUCCESS);
+    }
+  }
+  for (i = 0; i < n_writers; i++) {
+    wait(NULL);
+  }
+  clock_gettime(CLOCK_MONOTONIC, &end);
+
+  munmap(area, size);
+  return elapsed_seconds(&start, &end);
+}
+
+void write_slot(void *area, int slot, long iterations, int padded) {
+  volatile int *numerator_exponent;
+  long i;
+
+  /* Same access pattern as a factorer storing its exponent */
+  if (padded) {
+    numerator_exponent = &((struct TPadded_t *)area)->results[slot].numerator_exponent;
+  } else {
+    numerator_exponent = &((struct TPacked_t *)area)->numerator_exponents[slot];
+  }
+
+  for (i = 0; i < iterations; i++) {
+    (*numerator_exponent)++;
+  }
+}
+
+/******************** Auxiliar functions ********************/
+
+double elapsed_seconds(const struct timespec *start, const struct timespec *end) {
+  return (end->tv_sec - start->tv_sec) + (end->tv_nsec - start->tv_nsec) / 1e9;
+}
+
+void parse_argv(int argc, char *argv[], int *max_writers, long *iterations) {
+  *max_writers = DEFAULT_MAX_WRITERS;
+  *iterations = DEFAULT_ITERATIONS;
+
+  if (argc > 3) {
+    fprintf(stderr, "Synopsis: ./exec/bench_false_sharing [max_writers] [iterations].\n");
+    exit(EXIT_FAILURE);
+  }
+  if (argc > 1) {
+    *max_writers = atoi(argv[1]);
+  }
+  if (argc > 2) {
+    *iterations = atol(argv[2]);
+  }
+  if (*max_writers < 1 || *max_writers > N_PRIME_NUMBERS) {
+    fprintf(stderr, "max_writers must be between 1 and %d.\n", N_PRIME_NUMBERS);
+    exit(EXIT_FAILURE);
+  }
+}
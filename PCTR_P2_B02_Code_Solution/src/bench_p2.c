@@ -0,0 +1,308 @@
+/*
+====================================================================
+Concurrent and Real-Time Programming
+Faculty of Computer Science
+University of Castilla-La Mancha (Spain)
+
+Contact info: http://www.libropctr.com
+
+You can redistribute and/or modify this file under the terms of the
+GNU General Public License ad published by the Free Software
+Foundation, either version 3 of the License, or (at your option) and
+later version. See <http://www.gnu.org/licenses/>.
+
+This file is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+====================================================================
+*/
+
+/*
+  P2 benchmark suite. Acts as a manager of its own: it creates the IPC
+  objects, starts pools of 1..2 x cores looping factorers and factors
+  random fractions through the regular task path (notify_tasks() and
+  friends). Results are printed as CSV, one line per pool size, first with
+  free-running factorers and then pinned as the manager's --pin does. The
+  CPU migrations of the factorers and how many of them last ran outside
+  the NUMA node of the shared data show the placement effect.
+*/
+
+#define _DEFAULT_SOURCE
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <definitions.h>
+#include <arena.h>
+#include <placement.h>
+#include <semaphoreI.h>
+#include <tasks.h>
+
+#define DEFAULT_N_FRACTIONS 2000
+
+/* Environment */
+void create_environment(struct TData_t **p_data, struct TTask_t **p_task);
+void remove_environment(struct TData_t *data, struct TTask_t *task);
+void start_factorers(pid_t *pids, int n_factorers, int pinned);
+void stop_factorers(pid_t *pids, int n_factorers, struct TTask_t *task);
+
+/* Benchmark */
+void run_point(int n_factorers, int pinned, int n_fractions, struct TData_t *data, struct TTask_t *task);
+int random_number(int smooth);
+
+/* Auxiliar functions */
+int compare_doubles(const void *a, const void *b);
+int get_last_cpu(pid_t pid);
+long get_migrations(pid_t pid);
+int is_node_cpu(int cpu);
+double now_seconds();
+
+sem_t *g_sem_task_ready, *g_sem_task_read, *g_sem_task_processed;
+/* Own instance (PID), so the benchmark may run next to real managers */
+struct TIpcNames_t g_names;
+/* Task and data of the benchmark */
+struct TArena_t *g_arena;
+/* Cores of the NUMA node holding the data */
+int g_cpus[MAX_PLACEMENT_CPUS];
+int g_n_cpus;
+
+/******************** Main function ********************/
+
+int main(int argc, char *argv[]) {
+  struct TData_t *data;
+  struct TTask_t *task;
+  int n_factorers, max_factorers, n_fractions, pinned;
+
+  max_factorers = (argc > 1) ? atoi(argv[1]) : 2 * get_pool_size();
+  n_fractions = (argc > 2) ? atoi(argv[2]) : DEFAULT_N_FRACTIONS;
+  g_chunk_size = (argc > 3) ? atoi(argv[3]) : CHUNK_GUIDED;
+  if (max_factorers < 1 || n_fractions < 1 || g_chunk_size < 0) {
+    fprintf(stderr, "Synopsis: ./exec/bench_p2 [max_factorers] [fractions_per_point] [chunk (0: guided)].\n");
+    exit(EXIT_FAILURE);
+  }
+
+  g_verbose = FALSE;
+  srandom(1);
+  create_environment(&data, &task);
+
+  g_n_cpus = get_node_cpus(get_memory_node(data), g_cpus, MAX_PLACEMENT_CPUS);
+  if (g_n_cpus == 0) {
+    fprintf(stderr, "No core available to pin to: pinned runs skipped.\n");
+  }
+
+  /* dispatch_*: one sample per notify_tasks() call that dispatched tasks;
+     empty_dispatches: fractions with no task (cache hits) */
+  printf("factorers,pinned,fractions,tasks,fractions_per_s,tasks_per_s,"
+	 "dispatch_mean_ns,dispatch_p50_ns,dispatch_p99_ns,empty_dispatches,migrations,remote_factorers\n");
+  for (pinned = FALSE; pinned <= (g_n_cpus > 0); pinned++) {
+    for (n_factorers = 1; n_factorers < max_factorers; n_factorers *= 2) {
+      run_point(n_factorers, pinned, n_fractions, data, task);
+    }
+    run_point(max_factorers, pinned, n_fractions, data, task);
+  }
+
+  remove_environment(data, task);
+  return EXIT_SUCCESS;
+}
+
+/******************** Environment ********************/
+
+void create_environment(struct TData_t **p_data, struct TTask_t **p_task) {
+  char instance[MAX_INSTANCE_SIZE];
+
+  /* Same objects as the manager, so ./exec/factorer attaches as usual */
+  snprintf(instance, MAX_INSTANCE_SIZE, "%d", getpid());
+  get_ipc_names(instance, &g_names);
+  if ((g_arena = create_arena(g_names.shm_arena, ARENA_SIZE)) == NULL ||
+      (g_arena->task_offset = arena_alloc(g_arena, sizeof(struct TTask_t))) == 0 ||
+      (g_arena->data_offset = arena_alloc(g_arena, sizeof(struct TData_t))) == 0) {
+    remove_arena(g_names.shm_arena);
+    exit(EXIT_FAILURE);
+  }
+  *p_task = arena_ptr(g_arena, g_arena->task_offset);
+  *p_data = arena_ptr(g_arena, g_arena->data_offset);
+
+  g_sem_task_ready = create_semaphore(g_names.sem_task_ready, 0);
+  g_sem_task_read = create_semaphore(g_names.sem_task_read, 0);
+  g_sem_task_processed = create_semaphore(g_names.sem_task_processed, 0);
+}
+
+void remove_environment(struct TData_t *data, struct TTask_t *task) {
+  detach_arena(g_arena);
+  remove_arena(g_names.shm_arena);
+  remove_semaphore(g_names.sem_task_ready);
+  remove_semaphore(g_names.sem_task_read);
+  remove_semaphore(g_names.sem_task_processed);
+}
+
+void start_factorers(pid_t *pids, int n_factorers, int pinned) {
+  int i;
+
+  for (i = 0; i < n_factorers; i++) {
+    switch (pids[i] = fork()) {
+    case -1:
+      fprintf(stderr, "Error creating %s process: %s.\n", FACTORER_CLASS, strerror(errno));
+      exit(EXIT_FAILURE);
+    case 0:
+      execl(FACTORER_PATH, FACTORER_CLASS, g_names.instance, FACTORER_LOOP_FLAG, NULL);
+      fprintf(stderr, "Error using execl(): %s.\n", strerror(errno));
+      exit(EXIT_FAILURE);
+    }
+    if (pinned) {
+      pin_process(pids[i], g_cpus[i % g_n_cpus]);
+    }
+  }
+}
+
+void stop_factorers(pid_t *pids, int n_factorers, struct TTask_t *task) {
+  int i;
+
+  notify_stop(g_sem_task_ready, g_sem_task_read, task, n_factorers);
+  for (i = 0; i < n_factorers; i++) {
+    waitpid(pids[i], NULL, 0);
+  }
+}
+
+/******************** Benchmark ********************/
+
+void run_point(int n_factorers, int pinned, int n_fractions, struct TData_t *data, struct TTask_t *task) {
+  pid_t *pids;
+  double *dispatch_ns, start, t0, elapsed, total_dispatch = 0;
+  long total_tasks = 0, migrations = 0;
+  int i, n_tasks, n_samples = 0, n_empty, n_remote = 0;
+
+  pids = malloc(n_factorers * sizeof(pid_t));
+  dispatch_ns = malloc(n_fractions * sizeof(double));
+
+  start_factorers(pids, n_factorers, pinned);
+
+  start = now_seconds();
+  for (i = 0; i < n_fractions; i++) {
+    /* Same steps as factor_fraction(), without the factor cache */
+    init_data(data, random_number(i % 2), random_number(i % 3), N_PRIME_NUMBERS);
+
+    t0 = now_seconds();
+    n_tasks = notify_tasks(g_sem_task_ready, g_sem_task_read, data, task, N_PRIME_NUMBERS);
+    if (n_tasks > 0) {
+      dispatch_ns[n_samples] = (now_seconds() - t0) * 1e9;
+      total_dispatch += dispatch_ns[n_samples++];
+    }
+
+    wait_tasks_termination(g_sem_task_processed, n_tasks);
+    add_remaining_cofactors(data);
+    merge_results(data, N_PRIME_NUMBERS);
+
+    total_tasks += n_tasks;
+  }
+  elapsed = now_seconds() - start;
+
+  /* Placement effect, sampled while the factorers are still alive */
+  for (i = 0; i < n_factorers; i++) {
+    migrations += get_migrations(pids[i]);
+    n_remote += !is_node_cpu(get_last_cpu(pids[i]));
+  }
+
+  stop_factorers(pids, n_factorers, task);
+
+  /* Percentiles of the calls that dispatched tasks only */
+  n_empty = n_fractions - n_samples;
+  if (n_samples == 0) {
+    dispatch_ns[n_samples++] = 0;
+  }
+  qsort(dispatch_ns, n_samples, sizeof(double), compare_doubles);
+  printf("%d,%d,%d,%ld,%.0f,%.0f,%.0f,%.0f,%.0f,%d,%ld,%d\n", n_factorers, pinned, n_fractions,
+	 total_tasks, n_fractions / elapsed, total_tasks / elapsed, total_dispatch / n_samples,
+	 dispatch_ns[n_samples / 2], dispatch_ns[(int)(n_samples * 0.99)], n_empty, migrations, n_remote);
+  fflush(stdout);
+
+  free(dispatch_ns);
+  free(pids);
+}
+
+int random_number(int smooth) {
+  int number, i;
+
+  /* Uniform 31-bit value: few small factors, long dispatch loop */
+  if (!smooth) {
+    return (int)(random() | 1);
+  }
+
+  /* Product of table primes, like the values of make test/solution */
+  for (i = 0, number = 1; i < 12 && number < (1 << 22); i++) {
+    number *= g_primes[random() % 25];
+  }
+
+  return number;
+}
+
+/******************** Auxiliar functions ********************/
+
+int compare_doubles(const void *a, const void *b) {
+  double x = *(const double *)a, y = *(const double *)b;
+
+  return (x > y) - (x < y);
+}
+
+int get_last_cpu(pid_t pid) {
+  char path[64], line[1024], *fields;
+  FILE *stat;
+  int cpu = -1;
+
+  /* 'processor' is the 37th field after the command name */
+  snprintf(path, sizeof(path), "/proc/%d/stat", pid);
+  if ((stat = fopen(path, "r")) == NULL) {
+    return -1;
+  }
+  if (fgets(line, sizeof(line), stat) != NULL && (fields = strrchr(line, ')')) != NULL) {
+    sscanf(fields + 2, "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %*u %*u %*d %*d %*d %*d "
+	   "%*d %*d %*u %*u %*d %*u %*u %*u %*u %*u %*u %*u %*u %*u %*u %*u %*u %*u %*d %d", &cpu);
+  }
+  fclose(stat);
+
+  return cpu;
+}
+
+long get_migrations(pid_t pid) {
+  char path[64], line[256];
+  FILE *sched;
+  long migrations = 0;
+
+  snprintf(path, sizeof(path), "/proc/%d/sched", pid);
+  if ((sched = fopen(path, "r")) == NULL) {
+    return 0;
+  }
+  while (fgets(line, sizeof(line), sched) != NULL) {
+    if (sscanf(line, "se.nr_migrations : %ld", &migrations) == 1) {
+      break;
+    }
+  }
+  fclose(sched);
+
+  return migrations;
+}
+
+int is_node_cpu(int cpu) {
+  int i;
+
+  for (i = 0; i < g_n_cpus; i++) {
+    if (g_cpus[i] == cpu) {
+      return TRUE;
+    }
+  }
+
+  return FALSE;
+}
+
+double now_seconds() {
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
@@ -0,0 +1,81 @@
+/*
+====================================================================
+Concurrent and Real-Time Programming
+Faculty of Computer Science
+University of Castilla-La Mancha (Spain)
+
+Contact info: http://www.libropctr.com
+
+You can redistribute and/or modify this file under the terms of the
+GNU General Public License ad published by the Free Software
+Foundation, either version 3 of the License, or (at your option) and
+later version. See <http://www.gnu.org/licenses/>.
+
+This file is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+====================================================================
+*/
+
+#define _DEFAULT_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <semaphoreI.h>
+
+#define SEM_PING "sem_bench_ping"
+#define SEM_PONG "sem_bench_pong"
+
+#define DEFAULT_ROUND_TRIPS 100000
+
+/******************** Main function ********************/
+
+int main(int argc, char *argv[]) {
+  sem_t *sem_ping, *sem_pong;
+  struct timespec start, end;
+  long i, round_trips;
+  double elapsed;
+  pid_t pid;
+
+  round_trips = (argc > 1) ? atol(argv[1]) : DEFAULT_ROUND_TRIPS;
+
+  sem_ping = create_semaphore(SEM_PING, 0);
+  sem_pong = create_semaphore(SEM_PONG, 0);
+
+  /* Same rendezvous shape as notify_tasks()/get_and_process_task() */
+  if ((pid = fork()) == -1) {
+    perror("fork");
+    exit(EXIT_FAILURE);
+  }
+  if (pid == 0) {
+    sem_ping = get_semaphore(SEM_PING);
+    sem_pong = get_semaphore(SEM_PONG);
+    for (i = 0; i < round_trips; i++) {
+      wait_semaphore(sem_ping);
+      signal_semaphore(sem_pong);
+    }
+    exit(EXIT_SUCCESS);
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (i = 0; i < round_trips; i++) {
+    signal_semaphore(sem_ping);
+    wait_semaphore(sem_pong);
+  }
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  wait(NULL);
+
+  elapsed = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+  printf("%s,%ld,%.1f\n", argv[0], round_trips, elapsed * 1e9 / round_trips);
+
+  remove_semaphore(SEM_PING);
+  remove_semaphore(SEM_PONG);
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,140 @@
+/*
+====================================================================
+Concurrent and Real-Time Programming
+Faculty of Computer Science
+University of Castilla-La Mancha (Spain)
+
+Contact info: http://www.libropctr.com
+
+You can redistribute and/or modify this file under the terms of the
+GNU General Public License ad published by the Free Software
+Foundation, either version 3 of the License, or (at your option) and
+later version. See <http://www.gnu.org/licenses/>.
+
+This file is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+====================================================================
+*/
+
+#define _DEFAULT_SOURCE
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <definitions.h>
+#include <protocol.h>
+
+#define DEFAULT_N_REQUESTS 10000
+
+/* Benchmark */
+int connect_to_daemon(const char *socket_path);
+double timed_request(int fd, int numerator, int denominator);
+int random_factorable();
+
+/* Auxiliar functions */
+int compare_doubles(const void *a, const void *b);
+
+/******************** Main function ********************/
+
+int main(int argc, char *argv[]) {
+  char *socket_path;
+  double *latencies, total = 0;
+  long i, n_requests;
+  int fd;
+
+  socket_path = (argc > 1) ? argv[1] : FACTOR_SOCKET;
+  n_requests = (argc > 2) ? atol(argv[2]) : DEFAULT_N_REQUESTS;
+  latencies = malloc(n_requests * sizeof(double));
+
+  fd = connect_to_daemon(socket_path);
+
+  /* Requests over a single connection, one at a time */
+  srandom(1);
+  for (i = 0; i < n_requests; i++) {
+    latencies[i] = timed_request(fd, random_factorable(), random_factorable());
+    total += latencies[i];
+  }
+  close(fd);
+
+  qsort(latencies, n_requests, sizeof(double), compare_doubles);
+  printf("requests,mean_us,p50_us,p99_us,max_us,requests_per_s\n");
+  printf("%ld,%.1f,%.1f,%.1f,%.1f,%.0f\n", n_requests,
+	 total / n_requests * 1e6, latencies[n_requests / 2] * 1e6,
+	 latencies[(long)(n_requests * 0.99)] * 1e6, latencies[n_requests - 1] * 1e6,
+	 n_requests / total);
+
+  free(latencies);
+  return EXIT_SUCCESS;
+}
+
+/******************** Benchmark ********************/
+
+int connect_to_daemon(const char *socket_path) {
+  struct sockaddr_un address;
+  int fd;
+
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  strncpy(address.sun_path, socket_path, sizeof(address.sun_path) - 1);
+
+  if ((fd = socket(AF_UNIX, SOCK_STREAM, 0)) == -1 ||
+      connect(fd, (struct sockaddr *)&address, sizeof(address)) == -1) {
+    fprintf(stderr, "Error connecting to %s: %s.\n", socket_path, strerror(errno));
+    exit(EXIT_FAILURE);
+  }
+
+  return fd;
+}
+
+double timed_request(int fd, int numerator, int denominator) {
+  struct TRequest_t request;
+  struct TReplyHeader_t header;
+  struct TReplyFactor_t factors[MAX_REPLY_FACTORS];
+  struct timespec start, end;
+
+  request.numerator = numerator;
+  request.denominator = denominator;
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  if (!write_full(fd, &request, sizeof(request)) ||
+      !read_full(fd, &header, sizeof(header)) ||
+      header.n_factors < 0 || header.n_factors > MAX_REPLY_FACTORS ||
+      !read_full(fd, factors, header.n_factors * sizeof(struct TReplyFactor_t))) {
+    fprintf(stderr, "Error talking to the daemon.\n");
+    exit(EXIT_FAILURE);
+  }
+  clock_gettime(CLOCK_MONOTONIC, &end);
+
+  return (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+}
+
+int random_factorable() {
+  static const int small_primes[] = {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37};
+  int number = 1, i;
+
+  /* Products of small primes, like the values of make test/solution */
+  for (i = 0; i < 12; i++) {
+    if (number < (1 << 24)) {
+      number *= small_primes[random() % 12];
+    }
+  }
+
+  return number;
+}
+
+/******************** Auxiliar functions ********************/
+
+int compare_doubles(const void *a, const void *b) {
+  double x = *(const double *)a, y = *(const double *)b;
+
+  return (x > y) - (x < y);
+}
@@ -0,0 +1,380 @@
+/*
+====================================================================
+Concurrent and Real-Time Programming
+Faculty of Computer Science
+University of Castilla-La Mancha (Spain)
+
+Contact info: http://www.libropctr.com
+
+You can redistribute and/or modify this file under the terms of the
+GNU General Public License ad published by the Free Software
+Foundation, either version 3 of the License, or (at your option) and
+later version. See <http://www.gnu.org/licenses/>.
+
+This file is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+====================================================================
+*/
+
+/*
+  Coordinator of the distributed mode. Waits for n remote workers
+  (./exec/remote_worker) to attach over TCP and factors one fraction with
+  them. Tasks are split round-robin into one queue per worker; a worker
+  whose queue runs dry steals from the longest queue left. When a worker
+  is lost, its task in flight is retried elsewhere and its queue is moved
+  to the surviving workers.
+*/
+
+#define _DEFAULT_SOURCE
+
+#include <errno.h>
+#include <netdb.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <definitions.h>
+#include <divisibility.h>
+#include <remote.h>
+#include <tasks.h>
+
+struct TRemoteWorker_t {
+  int fd;                      /* -1 once lost */
+  int queue[N_PRIME_NUMBERS];  /* Prime positions, smallest first */
+  int head, tail;
+  int in_flight;               /* Position being processed (-1: idle) */
+};
+
+/* Worker management */
+int create_tcp_server(const char *port);
+void accept_workers(int server_fd, int n_workers);
+void lose_worker(int index);
+int live_workers();
+
+/* Task management */
+void distribute_tasks(struct TData_t *data);
+int dispatch_tasks(struct TData_t *data);
+int next_task(int index, struct TData_t *data);
+void collect_result(int index, struct TData_t *data);
+int is_useful_task(struct TData_t *data, int position);
+int is_valid_exponent(int cofactor, int position, int exponent);
+
+/* Auxiliar functions */
+void parse_argv(int argc, char *argv[], char **p_port, int *n_workers, int *numerator, int *denominator);
+void push_task(int index, int position);
+
+struct TRemoteWorker_t g_workers[MAX_REMOTE_WORKERS];
+int g_nWorkers;
+/* Dispatches of every task so far (bounded by MAX_TASK_ATTEMPTS) */
+int g_attempts[N_PRIME_NUMBERS];
+int g_nDispatches, g_nSteals, g_nRetries;
+/* The data lives only here (results are raw per-side exponents) */
+struct TData_t g_data;
+
+/******************** Main function ********************/
+
+int main(int argc, char *argv[]) {
+  char *port;
+  int server_fd, n_workers, numerator, denominator, i;
+
+  parse_argv(argc, argv, &port, &n_workers, &numerator, &denominator);
+
+  /* A lost worker must not kill the coordinator on write() */
+  signal(SIGPIPE, SIG_IGN);
+
+  server_fd = create_tcp_server(port);
+  accept_workers(server_fd, n_workers);
+
+  init_data(&g_data, numerator, denominator, N_PRIME_NUMBERS);
+  distribute_tasks(&g_data);
+  while (dispatch_tasks(&g_data)) {
+    ;
+  }
+
+  add_remaining_cofactors(&g_data);
+  merge_results(&g_data, N_PRIME_NUMBERS);
+  print_result(&g_data);
+  printf("[COORDINATOR] %d tasks dispatched (%d stolen, %d retried).\n", g_nDispatches, g_nSteals, g_nRetries);
+
+  /* Closing the connections releases the workers */
+  for (i = 0; i < g_nWorkers; i++) {
+    if (g_workers[i].fd != -1) {
+      close(g_workers[i].fd);
+    }
+  }
+  close(server_fd);
+
+  return EXIT_SUCCESS;
+}
+
+/******************** Worker management ********************/
+
+int create_tcp_server(const char *port) {
+  struct addrinfo hints, *address;
+  int fd, reuse = 1;
+
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_INET;
+  hints.ai_socktype = SOCK_STREAM;
+  hints.ai_flags = AI_PASSIVE;
+
+  if (getaddrinfo(NULL, port, &hints, &address) != 0) {
+    fprintf(stderr, "[COORDINATOR] Invalid port %s.\n", port);
+    exit(EXIT_FAILURE);
+  }
+  if ((fd = socket(address->ai_family, address->ai_socktype, 0)) == -1 ||
+      setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse)) == -1 ||
+      bind(fd, address->ai_addr, address->ai_addrlen) == -1 ||
+      listen(fd, SOMAXCONN) == -1) {
+    fprintf(stderr, "[COORDINATOR] Error listening on port %s: %s.\n", port, strerror(errno));
+    exit(EXIT_FAILURE);
+  }
+  freeaddrinfo(address);
+
+  return fd;
+}
+
+void accept_workers(int server_fd, int n_workers) {
+  int fd;
+
+  printf("[COORDINATOR] Waiting for %d workers...\n", n_workers);
+  fflush(stdout);
+
+  while (g_nWorkers < n_workers) {
+    if ((fd = accept(server_fd, NULL, NULL)) == -1) {
+      if (errno != EINTR) {
+	fprintf(stderr, "[COORDINATOR] Error using accept(): %s.\n", strerror(errno));
+      }
+      continue;
+    }
+    g_workers[g_nWorkers].fd = fd;
+    g_workers[g_nWorkers].head = g_workers[g_nWorkers].tail = 0;
+    g_workers[g_nWorkers].in_flight = -1;
+    g_nWorkers++;
+  }
+
+  printf("[COORDINATOR] %d workers attached.\n", g_nWorkers);
+}
+
+void lose_worker(int index) {
+  struct TRemoteWorker_t *worker = &g_workers[index];
+  int position, target = 0;
+
+  close(worker->fd);
+  worker->fd = -1;
+  fprintf(stderr, "[COORDINATOR] Worker %d lost.\n", index);
+
+  if (live_workers() == 0) {
+    fprintf(stderr, "[COORDINATOR] No workers left.\n");
+    exit(EXIT_FAILURE);
+  }
+
+  /* Retry the task in flight... */
+  if ((position = worker->in_flight) != -1) {
+    worker->in_flight = -1;
+    if (g_attempts[position] >= MAX_TASK_ATTEMPTS) {
+      fprintf(stderr, "[COORDINATOR] Task of prime %d failed %d times.\n",
+	      g_primes[position], g_attempts[position]);
+      exit(EXIT_FAILURE);
+    }
+    push_task(index, position);
+    g_nRetries++;
+  }
+
+  /* ...and hand the whole queue to the survivors */
+  while (worker->head < worker->tail) {
+    while (g_workers[target].fd == -1) {
+      target = (target + 1) % g_nWorkers;
+    }
+    push_task(target, worker->queue[worker->head++]);
+    target = (target + 1) % g_nWorkers;
+  }
+}
+
+int live_workers() {
+  int i, n_live = 0;
+
+  for (i = 0; i < g_nWorkers; i++) {
+    n_live += (g_workers[i].fd != -1);
+  }
+
+  return n_live;
+}
+
+/******************** Task management ********************/
+
+void distribute_tasks(struct TData_t *data) {
+  int position;
+
+  /* A prime above both magnitudes can divide neither side */
+  for (position = 0; position < N_PRIME_NUMBERS; position++) {
+    if (is_useful_task(data, position)) {
+      push_task(position % g_nWorkers, position);
+    }
+  }
+}
+
+int dispatch_tasks(struct TData_t *data) {
+  struct pollfd fds[MAX_REMOTE_WORKERS];
+  int indexes[MAX_REMOTE_WORKERS];
+  int i, n_fds = 0;
+
+  /* Keep one task in flight on every idle worker */
+  for (i = 0; i < g_nWorkers; i++) {
+    if (g_workers[i].fd != -1 && g_workers[i].in_flight == -1) {
+      next_task(i, data);
+    }
+  }
+
+  for (i = 0; i < g_nWorkers; i++) {
+    if (g_workers[i].fd != -1 && g_workers[i].in_flight != -1) {
+      fds[n_fds].fd = g_workers[i].fd;
+      fds[n_fds].events = POLLIN;
+      indexes[n_fds++] = i;
+    }
+  }
+  if (n_fds == 0) {
+    return FALSE; /* Nothing queued nor in flight */
+  }
+
+  if (poll(fds, n_fds, -1) == -1) {
+    if (errno != EINTR) {
+      fprintf(stderr, "[COORDINATOR] Error using poll(): %s.\n", strerror(errno));
+      exit(EXIT_FAILURE);
+    }
+    return TRUE;
+  }
+  for (i = 0; i < n_fds; i++) {
+    if (fds[i].revents != 0) {
+      collect_result(indexes[i], data);
+    }
+  }
+
+  return TRUE;
+}
+
+int next_task(int index, struct TData_t *data) {
+  struct TRemoteWorker_t *worker = &g_workers[index], *victim;
+  struct TRemoteTask_t task;
+  int i, position = -1, stolen = FALSE;
+
+  while (position == -1) {
+    if (worker->head < worker->tail) {
+      /* Own queue: smallest primes first */
+      position = worker->queue[worker->head++];
+    } else {
+      /* Steal the largest prime of the longest queue */
+      victim = NULL;
+      for (i = 0; i < g_nWorkers; i++) {
+	if (g_workers[i].fd != -1 &&
+	    (victim == NULL || g_workers[i].tail - g_workers[i].head > victim->tail - victim->head)) {
+	  victim = &g_workers[i];
+	}
+      }
+      if (victim->head == victim->tail) {
+	return FALSE;
+      }
+      position = victim->queue[--victim->tail];
+      stolen = (victim != worker);
+    }
+
+    /* Primes already factored out of both sides are dropped */
+    if (!is_useful_task(data, position)) {
+      position = -1;
+    }
+  }
+
+  task.numerator = data->numerator;
+  task.denominator = data->denominator;
+  task.prime_number = g_primes[position];
+  task.task.first_position = position;
+  task.task.last_position = position + 1;
+
+  worker->in_flight = position;
+  g_attempts[position]++;
+  g_nDispatches++;
+  g_nSteals += stolen;
+  if (!send_remote_task(worker->fd, &task)) {
+    lose_worker(index);
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+void collect_result(int index, struct TData_t *data) {
+  struct TRemoteWorker_t *worker = &g_workers[index];
+  struct TRemoteResult_t result;
+  int position = worker->in_flight;
+
+  if (!receive_remote_result(worker->fd, &result)) {
+    lose_worker(index);
+    return;
+  }
+  /* Nothing from the wire is trusted: the position must be the one in
+     flight and both exponents must divide exactly what is left */
+  if (result.prime_number_position < 0 || result.prime_number_position >= N_PRIME_NUMBERS ||
+      result.prime_number_position != position ||
+      !is_valid_exponent(data->numerator_cofactor, position, result.numerator_exponent) ||
+      !is_valid_exponent(data->denominator_cofactor, position, result.denominator_exponent)) {
+    fprintf(stderr, "[COORDINATOR] Invalid result from worker %d.\n", index);
+    lose_worker(index);
+    return;
+  }
+  worker->in_flight = -1;
+
+  /* Same bookkeeping as the factorers do in shared memory */
+  data->results[position].numerator_exponent = result.numerator_exponent;
+  data->results[position].denominator_exponent = result.denominator_exponent;
+  data->numerator_cofactor = exact_divide(&g_divisibility, position, data->numerator_cofactor,
+					  result.numerator_exponent);
+  data->denominator_cofactor = exact_divide(&g_divisibility, position, data->denominator_cofactor,
+					    result.denominator_exponent);
+}
+
+int is_useful_task(struct TData_t *data, int position) {
+  unsigned int prime = g_primes[position];
+
+  return prime <= magnitude(data->numerator_cofactor) || prime <= magnitude(data->denominator_cofactor);
+}
+
+int is_valid_exponent(int cofactor, int position, int exponent) {
+  unsigned int quotient;
+
+  /* Only this task divides by the prime: the cofactor still holds it all */
+  return exponent >= 0 &&
+    exponent <= multiplicity(&g_divisibility, position, magnitude(cofactor), &quotient);
+}
+
+/******************** Auxiliar functions ********************/
+
+void parse_argv(int argc, char *argv[], char **p_port, int *n_workers, int *numerator, int *denominator) {
+  if (argc != 5 || (*n_workers = atoi(argv[2])) < 1 || *n_workers > MAX_REMOTE_WORKERS) {
+    fprintf(stderr, "Synopsis: ./exec/coordinator <port> <workers (1-%d)> <numerator> <denominator>.\n",
+	    MAX_REMOTE_WORKERS);
+    exit(EXIT_FAILURE);
+  }
+
+  *p_port = argv[1];
+  *numerator = atoi(argv[3]);
+  *denominator = atoi(argv[4]);
+}
+
+void push_task(int index, int position) {
+  struct TRemoteWorker_t *worker = &g_workers[index];
+
+  /* Compact the queue once its tail reaches the end */
+  if (worker->tail == N_PRIME_NUMBERS) {
+    memmove(worker->queue, worker->queue + worker->head, (worker->tail - worker->head) * sizeof(int));
+    worker->tail -= worker->head;
+    worker->head = 0;
+  }
+  worker->queue[worker->tail++] = position;
+}
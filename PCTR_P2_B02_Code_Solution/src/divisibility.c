@@ -0,0 +1,141 @@
+/*
+====================================================================
+Concurrent and Real-Time Programming
+Faculty of Computer Science
+University of Castilla-La Mancha (Spain)
+
+Contact info: http://www.libropctr.com
+
+You can redistribute and/or modify this file under the terms of the
+GNU General Public License ad published by the Free Software
+Foundation, either version 3 of the License, or (at your option) and
+later version. See <http://www.gnu.org/licenses/>.
+
+This file is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+====================================================================
+*/
+
+#include <divisibility.h>
+
+typedef unsigned int vblock_t __attribute__((vector_size(DIV_BLOCK * sizeof(unsigned int))));
+
+void init_divisibility_table(struct TDivisibilityTable_t *table, const int *primes, int n_primes) {
+  int i;
+
+  table->n_primes = (n_primes < MAX_DIV_PRIMES) ? n_primes : MAX_DIV_PRIMES;
+  table->two_position = -1;
+
+  /* inverse 1 and limit 0 never match a non-zero number: used for 2 (no
+     inverse, handled apart in find_prime_divisors()) and for padding */
+  for (i = 0; i < MAX_DIV_PRIMES; i++) {
+    table->primes[i] = (i < table->n_primes) ? primes[i] : 0;
+    table->inverses[i] = 1;
+    table->limits[i] = 0;
+    if (i < table->n_primes && primes[i] == 2) {
+      table->two_position = i;
+    }
+    if (i < table->n_primes && (primes[i] & 1)) {
+      table->inverses[i] = modular_inverse(primes[i]);
+      table->limits[i] = 0xFFFFFFFFu / primes[i];
+    }
+  }
+}
+
+int find_prime_divisors(const struct TDivisibilityTable_t *table, unsigned int number, int *positions) {
+  vblock_t n, hits;
+  unsigned int any_hit;
+  int i, j, n_found = 0;
+
+  if (number == 0) {
+    return 0;
+  }
+
+  /* 2 is never reported by the vector test */
+  if (table->two_position != -1 && !(number & 1)) {
+    positions[n_found++] = table->two_position;
+  }
+
+  n = (vblock_t){0} + number;
+
+  for (i = 0; i < table->n_primes; i += DIV_BLOCK) {
+    /* Lanes set to ~0 where prime[lane] divides 'number' */
+    hits = (vblock_t)(n * *(const vblock_t *)&table->inverses[i] <= *(const vblock_t *)&table->limits[i]);
+
+    /* Most blocks have no divisor at all */
+    for (j = 0, any_hit = 0; j < DIV_BLOCK; j++) {
+      any_hit |= hits[j];
+    }
+    if (!any_hit) {
+      continue;
+    }
+    for (j = 0; j < DIV_BLOCK; j++) {
+      if (hits[j]) {
+	positions[n_found++] = i + j;
+      }
+    }
+  }
+
+  return n_found;
+}
+
+unsigned int modular_inverse(unsigned int odd) {
+  unsigned int inverse = odd; /* Correct to 3 bits */
+  int i;
+
+  /* Newton's iteration doubles the number of correct bits each step */
+  for (i = 0; i < 4; i++) {
+    inverse *= 2 - odd * inverse;
+  }
+
+  return inverse;
+}
+
+int multiplicity(const struct TDivisibilityTable_t *table, int position,
+		 unsigned int number, unsigned int *quotient) {
+  unsigned int inverse = table->inverses[position], limit = table->limits[position];
+  int times = 0;
+
+  if (number == 0) {
+    *quotient = 0;
+    return 0;
+  }
+
+  if (table->primes[position] == 2) {
+    times = __builtin_ctz(number);
+    *quotient = number >> times;
+    return times;
+  }
+
+  /* Exact division by multiplying with the cached inverse */
+  while (number * inverse <= limit) {
+    number *= inverse;
+    times++;
+  }
+
+  *quotient = number;
+  return times;
+}
+
+int exact_divide(const struct TDivisibilityTable_t *table, int position, int number, int times) {
+  unsigned int inverse = 1;
+  int i;
+
+  /* Only valid when prime^times divides 'number' (sign is preserved) */
+  if (table->primes[position] == 2) {
+    /* 64-bit: times reaches 31 for INT_MIN */
+    return (int)((long long)number / (1LL << times));
+  }
+  /* The inverse of prime^times is the cached inverse to the times */
+  for (i = 0; i < times; i++) {
+    inverse *= table->inverses[position];
+  }
+
+  return (int)((unsigned int)number * inverse);
+}
+
+unsigned int magnitude(int number) {
+  return (number < 0) ? 0u - (unsigned int)number : (unsigned int)number;
+}
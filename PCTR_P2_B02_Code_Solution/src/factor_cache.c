@@ -0,0 +1,226 @@
+/*
+====================================================================
+Concurrent and Real-Time Programming
+Faculty of Computer Science
+University of Castilla-La Mancha (Spain)
+
+Contact info: http://www.libropctr.com
+
+You can redistribute and/or modify this file under the terms of the
+GNU General Public License ad published by the Free Software
+Foundation, either version 3 of the License, or (at your option) and
+later version. See <http://www.gnu.org/licenses/>.
+
+This file is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+====================================================================
+*/
+
+#define _DEFAULT_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <factor_cache.h>
+
+#define CACHE_READ_RETRIES 64
+#define CACHE_RESETTING    0xFFFFFFFFu /* Magic while a process reinitializes */
+#define CACHE_RESET_WAIT_MS 1000
+
+/* Outcome of read_entry() */
+#define ENTRY_UNUSED 0
+#define ENTRY_READ   1
+#define ENTRY_BUSY   2
+
+/* Auxiliar functions */
+int check_header(struct TFactorCache_t *cache);
+unsigned int hash_number(int number);
+int is_current_layout(const struct TCacheHeader_t *header);
+int read_entry(struct TCacheEntry_t *entry, int *number, struct TFactors_t *factors);
+
+struct TFactorCache_t *open_factor_cache(void) {
+  struct TFactorCache_t *cache;
+  int fd;
+
+  /* A new segment is zero-filled (no magic yet); one of another size is
+     fitted to ours and then fails the header check */
+  if ((fd = shm_open(SHM_FACTOR_CACHE, O_CREAT | O_RDWR, 0644)) == -1 ||
+      ftruncate(fd, sizeof(struct TFactorCache_t)) == -1) {
+    fprintf(stderr, "[MANAGER] Factor cache unavailable: %s.\n", strerror(errno));
+    if (fd != -1) {
+      close(fd);
+    }
+    return NULL;
+  }
+
+  cache = mmap(NULL, sizeof(struct TFactorCache_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (cache == MAP_FAILED) {
+    return NULL;
+  }
+
+  /* Left by another build, or still being reset by a process that died */
+  if (!check_header(cache)) {
+    fprintf(stderr, "[MANAGER] Factor cache unavailable: stuck in a reset (make clean_cache).\n");
+    close_factor_cache(cache);
+    return NULL;
+  }
+
+  return cache;
+}
+
+void close_factor_cache(struct TFactorCache_t *cache) {
+  if (cache != NULL) {
+    munmap(cache, sizeof(struct TFactorCache_t));
+  }
+}
+
+int lookup_factors(struct TFactorCache_t *cache, int number, struct TFactors_t *factors) {
+  struct TCacheEntry_t *entry;
+  unsigned int slot;
+  int i, entry_number, outcome;
+
+  if (cache == NULL || number == 0) {
+    return 0;
+  }
+
+  slot = hash_number(number);
+  for (i = 0; i < CACHE_PROBES; i++) {
+    entry = &cache->entries[(slot + i) & (CACHE_SLOTS - 1)];
+    /* The probe chain ends at the first entry never used */
+    if ((outcome = read_entry(entry, &entry_number, factors)) == ENTRY_UNUSED) {
+      return 0;
+    }
+    if (outcome == ENTRY_READ && entry_number == number) {
+      __atomic_store_n(&entry->referenced, 1, __ATOMIC_RELAXED);
+      return 1;
+    }
+  }
+
+  return 0;
+}
+
+void store_factors(struct TFactorCache_t *cache, int number, const struct TFactors_t *factors) {
+  struct TCacheEntry_t *entry, *victim = NULL;
+  unsigned int slot, sequence;
+  int i, round;
+
+  if (cache == NULL || number == 0) {
+    return;
+  }
+
+  slot = hash_number(number);
+
+  /* Same number or unused entry in the probe window */
+  for (i = 0; i < CACHE_PROBES && victim == NULL; i++) {
+    entry = &cache->entries[(slot + i) & (CACHE_SLOTS - 1)];
+    if (__atomic_load_n(&entry->sequence, __ATOMIC_ACQUIRE) == 0 ||
+	__atomic_load_n(&entry->number, __ATOMIC_RELAXED) == number) {
+      victim = entry;
+    }
+  }
+
+  /* CLOCK: clear reference bits until an unreferenced entry shows up */
+  for (round = 0; round < 2 && victim == NULL; round++) {
+    for (i = 0; i < CACHE_PROBES; i++) {
+      entry = &cache->entries[(slot + i) & (CACHE_SLOTS - 1)];
+      if (!__atomic_exchange_n(&entry->referenced, 0, __ATOMIC_RELAXED)) {
+	victim = entry;
+	break;
+      }
+    }
+  }
+  if (victim == NULL) {
+    victim = &cache->entries[slot];
+  }
+
+  /* Writers exclude each other by making the sequence odd; if another
+     writer holds the entry, give up (it is only a cache) */
+  sequence = __atomic_load_n(&victim->sequence, __ATOMIC_ACQUIRE);
+  if ((sequence & 1) ||
+      !__atomic_compare_exchange_n(&victim->sequence, &sequence, sequence + 1, 0,
+				   __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+    return;
+  }
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+
+  __atomic_store_n(&victim->number, number, __ATOMIC_RELAXED);
+  memcpy(&victim->factors, factors, sizeof(struct TFactors_t));
+  __atomic_store_n(&victim->referenced, 1, __ATOMIC_RELAXED);
+
+  __atomic_store_n(&victim->sequence, sequence + 2, __ATOMIC_RELEASE);
+}
+
+/******************** Auxiliar functions ********************/
+
+int check_header(struct TFactorCache_t *cache) {
+  unsigned int magic;
+  int waited;
+
+  for (waited = 0; waited < CACHE_RESET_WAIT_MS; waited++) {
+    magic = __atomic_load_n(&cache->header.magic, __ATOMIC_ACQUIRE);
+    if (magic == CACHE_MAGIC && is_current_layout(&cache->header)) {
+      return 1;
+    }
+
+    /* New (zero-filled) or foreign segment: the first process to claim
+       the magic clears every entry, the others wait for it */
+    if (magic != CACHE_RESETTING &&
+	__atomic_compare_exchange_n(&cache->header.magic, &magic, CACHE_RESETTING, 0,
+				    __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+      if (magic != 0) {
+	fprintf(stderr, "[MANAGER] Factor cache from another build: reinitialized.\n");
+      }
+      memset(cache->entries, 0, sizeof(cache->entries));
+      cache->header.version = CACHE_VERSION;
+      cache->header.n_slots = CACHE_SLOTS;
+      cache->header.entry_size = sizeof(struct TCacheEntry_t);
+      __atomic_store_n(&cache->header.magic, CACHE_MAGIC, __ATOMIC_RELEASE);
+      return 1;
+    }
+    usleep(1000);
+  }
+
+  return 0;
+}
+
+unsigned int hash_number(int number) {
+  /* Fibonacci hashing */
+  return ((unsigned int)number * 2654435761u) >> (32 - CACHE_BITS);
+}
+
+int is_current_layout(const struct TCacheHeader_t *header) {
+  return header->version == CACHE_VERSION && header->n_slots == CACHE_SLOTS &&
+    header->entry_size == sizeof(struct TCacheEntry_t);
+}
+
+int read_entry(struct TCacheEntry_t *entry, int *number, struct TFactors_t *factors) {
+  unsigned int before, after;
+  int retries;
+
+  for (retries = 0; retries < CACHE_READ_RETRIES; retries++) {
+    if ((before = __atomic_load_n(&entry->sequence, __ATOMIC_ACQUIRE)) == 0) {
+      return ENTRY_UNUSED;
+    }
+    if (before & 1) {
+      continue;
+    }
+    *number = __atomic_load_n(&entry->number, __ATOMIC_RELAXED);
+    memcpy(factors, &entry->factors, sizeof(struct TFactors_t));
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    after = __atomic_load_n(&entry->sequence, __ATOMIC_RELAXED);
+    if (before == after) {
+      return ENTRY_READ;
+    }
+  }
+
+  /* Writer still busy (or died while writing): treat as a miss */
+  return ENTRY_BUSY;
+}
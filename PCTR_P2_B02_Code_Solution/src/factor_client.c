@@ -0,0 +1,124 @@
+/*
+====================================================================
+Concurrent and Real-Time Programming
+Faculty of Computer Science
+University of Castilla-La Mancha (Spain)
+
+Contact info: http://www.libropctr.com
+
+You can redistribute and/or modify this file under the terms of the
+GNU General Public License ad published by the Free Software
+Foundation, either version 3 of the License, or (at your option) and
+later version. See <http://www.gnu.org/licenses/>.
+
+This file is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+====================================================================
+*/
+
+#define _DEFAULT_SOURCE
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <definitions.h>
+#include <protocol.h>
+
+/* Service access */
+int connect_to_daemon(const char *socket_path);
+void request_fraction(int fd, int numerator, int denominator);
+
+/* Auxiliar functions */
+void parse_argv(int argc, char *argv[], char **p_socket_path, int *numerator, int *denominator);
+
+/******************** Main function ********************/
+
+int main(int argc, char *argv[]) {
+  char *socket_path;
+  int fd, numerator, denominator;
+
+  parse_argv(argc, argv, &socket_path, &numerator, &denominator);
+
+  fd = connect_to_daemon(socket_path);
+  request_fraction(fd, numerator, denominator);
+  close(fd);
+
+  return EXIT_SUCCESS;
+}
+
+/******************** Service access ********************/
+
+int connect_to_daemon(const char *socket_path) {
+  struct sockaddr_un address;
+  int fd;
+
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  strncpy(address.sun_path, socket_path, sizeof(address.sun_path) - 1);
+
+  if ((fd = socket(AF_UNIX, SOCK_STREAM, 0)) == -1 ||
+      connect(fd, (struct sockaddr *)&address, sizeof(address)) == -1) {
+    fprintf(stderr, "[CLIENT] Error connecting to %s: %s.\n", socket_path, strerror(errno));
+    exit(EXIT_FAILURE);
+  }
+
+  return fd;
+}
+
+void request_fraction(int fd, int numerator, int denominator) {
+  struct TRequest_t request;
+  struct TReplyHeader_t header;
+  struct TReplyFactor_t factors[MAX_REPLY_FACTORS];
+  int i;
+
+  request.numerator = numerator;
+  request.denominator = denominator;
+
+  if (!write_full(fd, &request, sizeof(request)) ||
+      !read_full(fd, &header, sizeof(header)) ||
+      header.n_factors < 0 || header.n_factors > MAX_REPLY_FACTORS ||
+      !read_full(fd, factors, header.n_factors * sizeof(struct TReplyFactor_t))) {
+    fprintf(stderr, "[CLIENT] Error talking to the daemon.\n");
+    exit(EXIT_FAILURE);
+  }
+  if (header.status != REPLY_OK) {
+    fprintf(stderr, "[CLIENT] Request rejected (status %d).\n", header.status);
+    exit(EXIT_FAILURE);
+  }
+
+  /* Same format as ./exec/manager */
+  printf("\nResult: ( ");
+  for (i = 0; i < header.n_factors; i++) {
+    if (factors[i].exponent > 0) {
+      printf("%d^%d ", factors[i].prime, factors[i].exponent);
+    }
+  }
+  printf(")/( ");
+  for (i = 0; i < header.n_factors; i++) {
+    if (factors[i].exponent < 0) {
+      printf("%d^%d ", factors[i].prime, -factors[i].exponent);
+    }
+  }
+  printf(")\n");
+}
+
+/******************** Auxiliar functions ********************/
+
+void parse_argv(int argc, char *argv[], char **p_socket_path, int *numerator, int *denominator) {
+  if (argc != 3 && argc != 4) {
+    fprintf(stderr, "Synopsis: ./exec/factor_client [socket] <numerator> <denominator>.\n");
+    exit(EXIT_FAILURE);
+  }
+
+  *p_socket_path = (argc == 4) ? argv[1] : FACTOR_SOCKET;
+  *numerator = atoi(argv[argc - 2]);
+  *denominator = atoi(argv[argc - 1]);
+}
@@ -18,104 +18,80 @@ General Public License for more details.
 ====================================================================
 */
 
-#include <fcntl.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <sys/mman.h>
-#include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
 
 #include <definitions.h>
+#include <arena.h>
+#include <ready.h>
 #include <semaphoreI.h>
+#include <tasks.h>
+
+/* IPC object names of the manager instance this factorer serves */
+struct TIpcNames_t g_names;
 
 /* Semaphores and shared memory retrieval */
-void close_shared_memory_segments(int shm_data, int shm_task);
-void get_shm_segments(int *shm_data, int *shm_task, struct TData_t **p_data, struct TTask_t **p_task);
+void close_shared_memory_segments(struct TArena_t *arena);
+void get_shm_segments(struct TArena_t **p_arena, struct TData_t **p_data, struct TTask_t **p_task);
 
 void get_sems(sem_t **p_sem_task_ready, sem_t **p_sem_task_read, sem_t **p_sem_task_processed);
 
-/* Task management */
-void get_and_process_task(sem_t *sem_task_ready, sem_t *sem_task_read, 
-			  struct TData_t *data, const struct TTask_t *task);
-void notify_task_completed(sem_t *sem_task_processed);
-
-/* Auxiliar functions */
-int how_many_times_divisible(int number, int prime);
-
 /******************** Main function ********************/
 
 int main(int argc, char *argv[]) {
   struct TData_t *data;
   struct TTask_t *task;
-  int shm_data, shm_task;
+  struct TArena_t *arena;
   sem_t *sem_task_ready, *sem_task_read, *sem_task_processed;
 
+  /* The manager passes its instance id as first argument */
+  if (argc < 2 || !get_ipc_names(argv[1], &g_names)) {
+    fprintf(stderr, "Synopsis: ./exec/factorer <instance> [%s].\n", FACTORER_LOOP_FLAG);
+    exit(EXIT_FAILURE);
+  }
+  name_semaphore_stats(g_names.instance);
+
   /* Get shared memory segments and semaphores */
-  get_shm_segments(&shm_data, &shm_task, &data, &task);
+  get_shm_segments(&arena, &data, &task);
   get_sems(&sem_task_ready, &sem_task_read, &sem_task_processed);
+  notify_ready();
+
+  if (argc > 2 && strcmp(argv[2], FACTORER_LOOP_FLAG) == 0) {
+    /* Pool member (daemon mode): until STOP_TASK */
+    while (get_and_process_task(sem_task_ready, sem_task_read, data, task)) {
+      notify_task_completed(sem_task_processed);
+    }
+  } else {
+    /* One single iteration */
+    get_and_process_task(sem_task_ready, sem_task_read, data, task);
+    notify_task_completed(sem_task_processed);
+  }
 
-  /* One single iteration */
-  get_and_process_task(sem_task_ready, sem_task_read, data, task);
-  notify_task_completed(sem_task_processed);
-
-  close_shared_memory_segments(shm_data, shm_task);
+  close_shared_memory_segments(arena);
 
   return EXIT_SUCCESS;
 }
 
 /******************** Semaphores and shared memory retrieval ********************/
 
-void close_shared_memory_segments(int shm_data, int shm_task) {
-  close(shm_data);
-  close(shm_task);
+void close_shared_memory_segments(struct TArena_t *arena) {
+  detach_arena(arena);
 }
 
-void get_shm_segments(int *shm_data, int *shm_task, struct TData_t **data, struct TTask_t **task) {
-  *shm_data = shm_open(SHM_DATA, O_RDWR, 0644);
-  *data = mmap(NULL, sizeof(struct TData_t), PROT_READ | PROT_WRITE, MAP_SHARED, *shm_data, 0);
-
-  *shm_task = shm_open(SHM_TASK, O_RDWR, 0644);
-  *task = mmap(NULL, sizeof(struct TTask_t), PROT_READ | PROT_WRITE, MAP_SHARED, *shm_task, 0);
-}
-
-void get_sems(sem_t **p_sem_task_ready, sem_t **p_sem_task_read, sem_t **p_sem_task_processed) {
-  *p_sem_task_ready = get_semaphore(SEM_TASK_READY);
-  *p_sem_task_read = get_semaphore(SEM_TASK_READ);
-  *p_sem_task_processed = get_semaphore(SEM_TASK_PROCESSED);
-}
-
-/******************** Task management ********************/
-void get_and_process_task(sem_t *sem_task_ready, sem_t *sem_task_read, struct TData_t *data, const struct TTask_t *task){
-  
-  int prime_number, prime_number_position, numerator, denominator, xnumerator, xdenominator;
- 
-  wait_semaphore(sem_task_ready);
-  prime_number = task->prime_number;
-  prime_number_position = task->prime_number_position;
-  numerator = data->numerator;
-  denominator = data->denominator; 
-  signal_semaphore(sem_task_read);
-
-  if((xnumerator=how_many_times_divisible(numerator,prime_number)) > (xdenominator = how_many_times_divisible(denominator,prime_number)) ){
-    data->numerator_exponents[prime_number_position] = xnumerator-xdenominator;
-    data->denominator_exponents[prime_number_position] = 0;
-  }else{
-    data->denominator_exponents[prime_number_position] = xdenominator-xnumerator;
-    data->numerator_exponents[prime_number_position] = 0;
+void get_shm_segments(struct TArena_t **p_arena, struct TData_t **data, struct TTask_t **task) {
+  /* One (pre-faulted) mapping for everything the manager shares */
+  if ((*p_arena = attach_arena(g_names.shm_arena)) == NULL) {
+    exit(EXIT_FAILURE);
   }
-  
+  *task = arena_ptr(*p_arena, (*p_arena)->task_offset);
+  *data = arena_ptr(*p_arena, (*p_arena)->data_offset);
 }
-void notify_task_completed(sem_t *sem_task_processed){
-  signal_semaphore(sem_task_processed);
-}
-/******************** Auxiliar functions ********************/
-
-int how_many_times_divisible(int number, int prime) {
-  int times;
 
-  for (times = 0; !(number % prime); times++, number = (number / prime));
-
-  return times;
+void get_sems(sem_t **p_sem_task_ready, sem_t **p_sem_task_read, sem_t **p_sem_task_processed) {
+  *p_sem_task_ready = get_semaphore(g_names.sem_task_ready);
+  *p_sem_task_read = get_semaphore(g_names.sem_task_read);
+  *p_sem_task_processed = get_semaphore(g_names.sem_task_processed);
 }
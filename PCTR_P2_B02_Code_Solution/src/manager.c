@@ -30,59 +30,66 @@ General Public License for more details.
 #include <stdlib.h>
 #include <string.h>
 #include <sys/mman.h>
+#include <sys/socket.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <sys/un.h>
 #include <sys/wait.h>
 #include <unistd.h>
 
 #include <definitions.h>
+#include <arena.h>
+#include <factor_cache.h>
+#include <placement.h>
+#include <protocol.h>
+#include <ready.h>
 #include <semaphoreI.h>
+#include <tasks.h>
 
 /* Total number of processes */
 int g_nProcesses;
 /* 'Process table' (child processes) */
 struct TProcess_t *g_process_table;
-
-/* First n prime numbers */
-int g_primes[] = {
-  2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47, 53, 59, 61, 67,
-  71, 73, 79, 83, 89, 97, 101, 103, 107, 109, 113, 127, 131, 137, 139, 149, 151, 157,
-  163, 167, 173, 179, 181, 191, 193, 197, 199, 211, 223, 227, 229, 233, 239, 241, 251,
-  257, 263, 269, 271, 277, 281, 283, 293, 307, 311, 313, 317, 331, 337, 347, 349, 353,
-  359, 367, 373, 379, 383, 389, 397, 401, 409, 419, 421, 431, 433, 439, 443, 449, 457,
-  461, 463, 467, 479, 487, 491, 499, 503, 509, 521, 523, 541, 547
-}; 
+/* Socket of the daemon mode (NULL when serving a single fraction) */
+char *g_socket_path = NULL;
+/* IPC object names of this instance (several managers may run at once) */
+struct TIpcNames_t g_names;
+/* Pin every factorer to one core (see placement.h) */
+int g_pin = FALSE;
 
 /* Process management */
 
-void create_processes_by_class(enum ProcessClass_t class, int n_processes, int index_process_table);
+void create_processes_by_class(enum ProcessClass_t class, int n_processes, int index_process_table,
+			       const char *argv);
 pid_t create_single_process(const char *class, const char *path, const char *argv);
 void get_str_process_info(enum ProcessClass_t class, char **path, char **str_process_class);
 void init_process_table(int n_factorers);
+void pin_processes(void *shared, int n_processes, int index_process_table);
 void terminate_processes();
 void wait_processes();
 
 /* Semaphores and shared memory management */
 
-void create_shm_segments(int *shm_data, int *shm_task,
+void create_shm_segments(struct TArena_t **p_arena,
 			 struct TData_t **p_data, struct TTask_t **p_task, 
 			 int numerator, int denominator, int n_prime_numbers);
 
 void create_sems(sem_t **p_sem_task_ready, sem_t **p_sem_task_read, sem_t **p_sem_task_processed);
 
-void close_shared_memory_segments(int shm_data, int shm_task);
+void close_shared_memory_segments(struct TArena_t *arena);
 
-/* Task management */
+/* Daemon mode */
 
-void notify_tasks(sem_t *sem_task_ready, sem_t *sem_task_read, struct TTask_t *task, int n_tasks);
-void wait_tasks_termination(sem_t *sem_task_processed, int n_tasks);
+void run_daemon(const char *socket_path);
+int create_server_socket(const char *socket_path);
+void serve_connection(int fd, sem_t *sem_task_ready, sem_t *sem_task_read, sem_t *sem_task_processed,
+		      struct TFactorCache_t *cache, struct TData_t *data, struct TTask_t *task);
 
 /* Auxiliar functions */
 
 void free_resources();
 void install_signal_handler();
-void parse_argv(int argc, char *argv[], int *numerator, int *denominator);
-void print_result(struct TData_t *data);
+void parse_argv(int argc, char *argv[], int *numerator, int *denominator, char **p_socket_path);
 void signal_handler(int signo);
 
 /******************** Main function ********************/
@@ -90,37 +97,54 @@ void signal_handler(int signo);
 int main(int argc, char *argv[]) {
   struct TData_t *data;
   struct TTask_t *task;
-  int shm_data, shm_task;
+  struct TArena_t *arena;
   sem_t *sem_task_ready, *sem_task_read, *sem_task_processed;
 
-  int numerator, denominator;
+  struct TFactorCache_t *cache;
+  int numerator, denominator, n_factorers, cached;
+  char *socket_path = NULL;
 
   /* Install signal handler and parse arguments*/
   install_signal_handler();
-  parse_argv(argc, argv, &numerator, &denominator);
+  parse_argv(argc, argv, &numerator, &denominator, &socket_path);
 
-  /* Init the process table*/
-  init_process_table(N_PRIME_NUMBERS);
+  /* Long-running service: never returns */
+  if (socket_path != NULL) {
+    run_daemon(socket_path);
+  }
 
   /* Create shared memory segments and semaphores */
-  create_shm_segments(&shm_data, &shm_task, &data, &task, numerator, denominator, N_PRIME_NUMBERS);
+  create_shm_segments(&arena, &data, &task, numerator, denominator, N_PRIME_NUMBERS);
   create_sems(&sem_task_ready, &sem_task_read, &sem_task_processed);
 
-  /* Create processes */
-  create_processes_by_class(FACTORER, N_PRIME_NUMBERS, 0);
+  /* Tasks first: no more factorers than tasks (none on a cache hit) */
+  cache = open_factor_cache();
+  cached = prepare_fraction(cache, data, numerator, denominator);
+  n_factorers = count_tasks(data, N_PRIME_NUMBERS);
+  n_factorers = (n_factorers < get_pool_size()) ? n_factorers : get_pool_size();
+
+  /* Init the process table and create processes */
+  init_process_table(n_factorers);
+  if (n_factorers > 0) {
+    create_processes_by_class(FACTORER, n_factorers, 0, FACTORER_LOOP_FLAG);
+    if (g_pin) {
+      pin_processes(data, n_factorers, 0);
+    }
+  }
 
   /* Manage tasks */
-  notify_tasks(sem_task_ready, sem_task_read, task, N_PRIME_NUMBERS);
-  wait_tasks_termination(sem_task_processed, N_PRIME_NUMBERS);
+  complete_fraction(sem_task_ready, sem_task_read, sem_task_processed, cache, data, task, cached);
+  close_factor_cache(cache);
 
-  /* Wait for child processes */
+  /* Wait for child processes (each one takes a STOP_TASK) */
+  notify_stop(sem_task_ready, sem_task_read, task, n_factorers);
   wait_processes();
 
   /* Print the obtained result */
   print_result(data);
 
   /* Free resources and terminate */
-  close_shared_memory_segments(shm_data, shm_task);
+  close_shared_memory_segments(arena);
   free_resources();
 
   return EXIT_SUCCESS;
@@ -128,15 +152,22 @@ int main(int argc, char *argv[]) {
 
 /******************** Process Management ********************/
 
-void create_processes_by_class(enum ProcessClass_t class, int n_processes, int index_process_table) {
+void create_processes_by_class(enum ProcessClass_t class, int n_processes, int index_process_table,
+			       const char *argv) {
   char *path = NULL, *str_process_class = NULL;
-  int i;
+  int i, ready_fd;
   pid_t pid;
 
   get_str_process_info(class, &path, &str_process_class);
 
+  if ((ready_fd = open_ready_channel()) == -1) {
+    fprintf(stderr, "[MANAGER] Error creating the readiness pipe: %s.\n", strerror(errno));
+    terminate_processes();
+    free_resources();
+    exit(EXIT_FAILURE);
+  }
   for (i = index_process_table; i < (index_process_table + n_processes); i++) {
-    pid = create_single_process(path, str_process_class, NULL);
+    pid = create_single_process(path, str_process_class, argv);
 
     g_process_table[i].class = class;
     g_process_table[i].pid = pid;
@@ -144,7 +175,12 @@ void create_processes_by_class(enum ProcessClass_t class, int n_processes, int i
   }
 
   printf("[MANAGER] %d %s processes created.\n", n_processes, str_process_class);
-  sleep(1);
+  if (!wait_ready(ready_fd, n_processes, READY_TIMEOUT_MS)) {
+    fprintf(stderr, "[MANAGER] Not every %s process reported ready.\n", str_process_class);
+    terminate_processes();
+    free_resources();
+    exit(EXIT_FAILURE);
+  }
 }
 
 pid_t create_single_process(const char *path, const char *class, const char *argv) {
@@ -157,9 +193,9 @@ pid_t create_single_process(const char *path, const char *class, const char *arg
     terminate_processes();
     free_resources();
     exit(EXIT_FAILURE);
-  /* Child process */
+  /* Child process: the instance tells it which IPC objects to open */
   case 0 : 
-    if (execl(path, class, argv, NULL) == -1) {
+    if (execl(path, class, g_names.instance, argv, NULL) == -1) {
       fprintf(stderr, "[MANAGER] Error using execl() in %s process: %s.\n", 
 	      class, strerror(errno));
       exit(EXIT_FAILURE);
@@ -193,6 +229,24 @@ void init_process_table(int n_factorers) {
   }
 }
 
+void pin_processes(void *shared, int n_processes, int index_process_table) {
+  int cpus[MAX_PLACEMENT_CPUS];
+  int i, node, n_cpus, n_pinned = 0;
+
+  /* Round-robin over the cores next to the shared data */
+  node = get_memory_node(shared);
+  n_cpus = get_node_cpus(node, cpus, MAX_PLACEMENT_CPUS);
+  if (n_cpus == 0) {
+    fprintf(stderr, "[MANAGER] No core available to pin to: processes left unpinned.\n");
+    return;
+  }
+  for (i = 0; i < n_processes; i++) {
+    n_pinned += pin_process(g_process_table[index_process_table + i].pid, cpus[i % n_cpus]);
+  }
+
+  printf("[MANAGER] %d processes pinned to %d cores of NUMA node %d.\n", n_pinned, n_cpus, node);
+}
+
 void terminate_processes() {
   int i;
   
@@ -230,62 +284,138 @@ void wait_processes() {
 
 /******************** Semaphores and shared memory management ********************/
 
-void create_shm_segments(int *shm_data, int *shm_task,
+void create_shm_segments(struct TArena_t **p_arena,
 			 struct TData_t **p_data, struct TTask_t **p_task, 
 			 int numerator, int denominator, int n_prime_numbers) {
-  int i;
-
-  /* Create and initialize shared memory segments */
-  *shm_data = shm_open(SHM_DATA, O_CREAT | O_RDWR, 0644); 
-  ftruncate(*shm_data, sizeof(struct TData_t));          
-  *p_data = mmap(NULL, sizeof(struct TData_t), PROT_READ | PROT_WRITE, MAP_SHARED, *shm_data, 0);
-
-  *shm_task = shm_open(SHM_TASK, O_CREAT | O_RDWR, 0644);
-  ftruncate(*shm_task, sizeof(struct TTask_t));
-  *p_task = mmap(NULL, sizeof(struct TTask_t), PROT_READ | PROT_WRITE, MAP_SHARED, *shm_task, 0);
+  struct TArena_t *arena;
+
+  /* Create the arena and lay out the task and the data inside */
+  if ((arena = create_arena(g_names.shm_arena, ARENA_SIZE)) == NULL ||
+      (arena->task_offset = arena_alloc(arena, sizeof(struct TTask_t))) == 0 ||
+      (arena->data_offset = arena_alloc(arena, sizeof(struct TData_t))) == 0) {
+    fprintf(stderr, "[MANAGER] Error creating shared memory segments.\n");
+    remove_arena(g_names.shm_arena);
+    exit(EXIT_FAILURE);
+  }
+  *p_arena = arena;
+  *p_task = arena_ptr(arena, arena->task_offset);
+  *p_data = arena_ptr(arena, arena->data_offset);
 
   /* SHM data initialization */
-  (*p_data)->numerator = numerator;
-  (*p_data)->denominator = denominator;
-  for (i = 0; i < n_prime_numbers; i++) {
-    (*p_data)->numerator_exponents[i] = 0;
-    (*p_data)->denominator_exponents[i] = 0;
-  }
+  init_data(*p_data, numerator, denominator, n_prime_numbers);
 }
 
 void create_sems(sem_t **p_sem_task_ready, sem_t **p_sem_task_read, sem_t **p_sem_task_processed) {  
   /* Create and initialize semaphores */
-  *p_sem_task_ready = create_semaphore(SEM_TASK_READY,0); 
-  *p_sem_task_read = create_semaphore(SEM_TASK_READ,0);
-  *p_sem_task_processed = create_semaphore(SEM_TASK_PROCESSED,0);
+  *p_sem_task_ready = create_semaphore(g_names.sem_task_ready,0); 
+  *p_sem_task_read = create_semaphore(g_names.sem_task_read,0);
+  *p_sem_task_processed = create_semaphore(g_names.sem_task_processed,0);
 }
 
-void close_shared_memory_segments(int shm_data, int shm_task) {
-  close(shm_data);
-  close(shm_task);
+void close_shared_memory_segments(struct TArena_t *arena) {
+  detach_arena(arena);
 }
 
-/******************** Task management ********************/
+/******************** Daemon mode ********************/
 
-void notify_tasks(sem_t *sem_task_ready, sem_t *sem_task_read, struct TTask_t *task, int n_tasks) {
-  int i;
+void run_daemon(const char *socket_path) {
+  struct TData_t *data;
+  struct TTask_t *task;
+  struct TFactorCache_t *cache;
+  struct TArena_t *arena;
+  int server_fd, client_fd, n_factorers;
+  sem_t *sem_task_ready, *sem_task_read, *sem_task_processed;
 
-  for (i = 0; i < n_tasks; i++) {
-    task->prime_number = g_primes[i];
-    task->prime_number_position = i;
-    /* Task notification through rendezvous */
-    signal_semaphore(sem_task_ready);
-    wait_semaphore(sem_task_read);
+  /* Everything is set up once and kept warm between requests */
+  n_factorers = get_pool_size();
+  init_process_table(n_factorers);
+  create_shm_segments(&arena, &data, &task, 1, 1, N_PRIME_NUMBERS);
+  create_sems(&sem_task_ready, &sem_task_read, &sem_task_processed);
+  create_processes_by_class(FACTORER, n_factorers, 0, FACTORER_LOOP_FLAG);
+  if (g_pin) {
+    pin_processes(data, n_factorers, 0);
+  }
+  cache = open_factor_cache();
+
+  /* A client gone mid-reply must not kill the daemon on write(): it gets
+     EPIPE and the connection is dropped. Set after the factorers are
+     created, as an ignored signal survives exec() */
+  signal(SIGPIPE, SIG_IGN);
+  server_fd = create_server_socket(socket_path);
+  g_verbose = FALSE;
+
+  printf("[MANAGER] Serving fractions on %s (Ctrl + C to stop).\n", socket_path);
+  fflush(stdout);
+
+  /* One client at a time; the factorer pool provides the parallelism */
+  while (TRUE) {
+    if ((client_fd = accept(server_fd, NULL, NULL)) == -1) {
+      if (errno != EINTR) {
+	fprintf(stderr, "[MANAGER] Error using accept(): %s.\n", strerror(errno));
+      }
+      continue;
+    }
+    serve_connection(client_fd, sem_task_ready, sem_task_read, sem_task_processed, cache, data, task);
+    close(client_fd);
   }
+}
+
+int create_server_socket(const char *socket_path) {
+  struct sockaddr_un address;
+  int fd;
+
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  strncpy(address.sun_path, socket_path, sizeof(address.sun_path) - 1);
+
+  /* Leftover of a previous daemon */
+  unlink(socket_path);
+
+  if ((fd = socket(AF_UNIX, SOCK_STREAM, 0)) == -1 ||
+      bind(fd, (struct sockaddr *)&address, sizeof(address)) == -1 ||
+      listen(fd, SOMAXCONN) == -1) {
+    fprintf(stderr, "[MANAGER] Error creating socket %s: %s.\n", socket_path, strerror(errno));
+    terminate_processes();
+    free_resources();
+    exit(EXIT_FAILURE);
+  }
+  g_socket_path = (char *)socket_path;
 
+  return fd;
 }
 
-void wait_tasks_termination(sem_t *sem_task_processed, int n_tasks) {
- int n_tasks_processed = 0;
+void serve_connection(int fd, sem_t *sem_task_ready, sem_t *sem_task_read, sem_t *sem_task_processed,
+		      struct TFactorCache_t *cache, struct TData_t *data, struct TTask_t *task) {
+  struct TRequest_t request;
+  struct TReplyHeader_t header;
+  struct TReplyFactor_t factors[MAX_REPLY_FACTORS];
+  int i;
+
+  while (read_full(fd, &request, sizeof(request))) {
+    header.status = REPLY_OK;
+    header.n_factors = 0;
+
+    if (request.numerator == 0 || request.denominator == 0) {
+      header.status = REPLY_BAD_REQUEST;
+    } else {
+      factor_fraction(sem_task_ready, sem_task_read, sem_task_processed,
+		      cache, data, task, request.numerator, request.denominator);
+
+      /* Sparse reply: only primes with a non-zero exponent */
+      for (i = 0; i < N_PRIME_NUMBERS; i++) {
+	if (data->numerator_exponents[i] > 0 || data->denominator_exponents[i] > 0) {
+	  factors[header.n_factors].prime = g_primes[i];
+	  factors[header.n_factors].exponent = data->numerator_exponents[i] - data->denominator_exponents[i];
+	  header.n_factors++;
+	}
+      }
+    }
 
-  while (n_tasks_processed < n_tasks) {
-    wait_semaphore(sem_task_processed);                         
-    n_tasks_processed++;   
+    if (!write_full(fd, &header, sizeof(header)) ||
+	!write_full(fd, factors, header.n_factors * sizeof(struct TReplyFactor_t))) {
+      /* Client gone (EPIPE, ECONNRESET): drop this connection */
+      return;
+    }
   }
 }
 
@@ -297,14 +427,20 @@ void free_resources() {
   /* Free the 'process table' memory */
   free(g_process_table); 
 
-  /* Semaphores */ 
-  remove_semaphore(SEM_TASK_READY);
-  remove_semaphore(SEM_TASK_READ);
-  remove_semaphore(SEM_TASK_PROCESSED);
+  /* Semaphores (and their wait statistics, if enabled) */ 
+  print_semaphore_stats();
+  remove_semaphore(g_names.sem_task_ready);
+  remove_semaphore(g_names.sem_task_read);
+  remove_semaphore(g_names.sem_task_processed);
+  remove_semaphore_stats();
 
   /* Shared memory segments*/
-  shm_unlink(SHM_TASK);
-  shm_unlink(SHM_DATA);
+  remove_arena(g_names.shm_arena);
+
+  /* Daemon socket */
+  if (g_socket_path != NULL) {
+    unlink(g_socket_path);
+  }
 }
 
 void install_signal_handler() {
@@ -314,9 +450,51 @@ void install_signal_handler() {
   }
 }
 
-void parse_argv(int argc, char *argv[], int *numerator, int *denominator) {
+void parse_argv(int argc, char *argv[], int *numerator, int *denominator, char **p_socket_path) {
+  char pid_instance[MAX_INSTANCE_SIZE];
+  const char *instance = pid_instance;
+
+  /* Instance id: the manager's PID unless given explicitly */
+  snprintf(pid_instance, MAX_INSTANCE_SIZE, "%d", getpid());
+
+  /* Leading options, in any order */
+  while (argc >= 2) {
+    if (argc >= 3 && strcmp(argv[1], INSTANCE_FLAG) == 0) {
+      instance = argv[2];
+      argc -= 2;
+      argv += 2;
+    } else if (strcmp(argv[1], PIN_FLAG) == 0) {
+      g_pin = TRUE;
+      argc--;
+      argv++;
+    } else if (argc >= 3 && strcmp(argv[1], CHUNK_FLAG) == 0) {
+      g_chunk_size = (strcmp(argv[2], "guided") == 0) ? CHUNK_GUIDED : atoi(argv[2]);
+      if (g_chunk_size < 0 || (g_chunk_size == CHUNK_GUIDED && strcmp(argv[2], "guided") != 0)) {
+	fprintf(stderr, "[MANAGER] Invalid chunk size '%s' (<n> or guided).\n", argv[2]);
+	exit(EXIT_FAILURE);
+      }
+      argc -= 2;
+      argv += 2;
+    } else {
+      break;
+    }
+  }
+  if (!get_ipc_names(instance, &g_names)) {
+    fprintf(stderr, "[MANAGER] Invalid instance '%s' (up to %d characters in [A-Za-z0-9_-]).\n",
+	    instance, MAX_INSTANCE_SIZE - 1);
+    exit(EXIT_FAILURE);
+  }
+  name_semaphore_stats(g_names.instance);
+
+  if (argc >= 2 && argc <= 3 && strcmp(argv[1], DAEMON_FLAG) == 0) {
+    *p_socket_path = (argc == 3) ? argv[2] : FACTOR_SOCKET;
+    return;
+  }
+
   if (argc != 3) {
-    fprintf(stderr, "Synopsis: ./exec/manager <numerator> <denominator>.\n");    
+    fprintf(stderr, "Synopsis: ./exec/manager [%s id] [%s] [%s n|guided] <numerator> <denominator>.\n"
+	    "          ./exec/manager [%s id] [%s] [%s n|guided] %s [socket].\n",
+	    INSTANCE_FLAG, PIN_FLAG, CHUNK_FLAG, INSTANCE_FLAG, PIN_FLAG, CHUNK_FLAG, DAEMON_FLAG);    
     exit(EXIT_FAILURE); 
   }
   
@@ -324,26 +502,6 @@ void parse_argv(int argc, char *argv[], int *numerator, int *denominator) {
   *denominator = atoi(argv[2]);
 }
 
-void print_result(struct TData_t *data) {
-  int i, n_prime_numbers;
-
-  n_prime_numbers = sizeof(g_primes) / sizeof(g_primes[0]);
-
-  printf("\nResult: ( ");
-  for (i = 0; i < n_prime_numbers; i++) {
-    if (data->numerator_exponents[i] > 0) {
-      printf("%d^%d ", g_primes[i], data->numerator_exponents[i]);
-    }
-  }
-  printf(")/( ");
-  for (i = 0; i < n_prime_numbers; i++) {
-    if (data->denominator_exponents[i] > 0) {
-      printf("%d^%d ", g_primes[i], data->denominator_exponents[i]);
-    }
-  }
-  printf(")\n");
-}
-
 void signal_handler(int signo) {
   printf("\n[MANAGER] Program termination (Ctrl + C).\n");
   terminate_processes();
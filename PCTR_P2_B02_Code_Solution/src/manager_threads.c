@@ -0,0 +1,158 @@
+/*
+====================================================================
+Concurrent and Real-Time Programming
+Faculty of Computer Science
+University of Castilla-La Mancha (Spain)
+
+Contact info: http://www.libropctr.com
+
+You can redistribute and/or modify this file under the terms of the
+GNU General Public License ad published by the Free Software
+Foundation, either version 3 of the License, or (at your option) and
+later version. See <http://www.gnu.org/licenses/>.
+
+This file is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+====================================================================
+*/
+
+/*
+  Threaded engine: same command line and output as ./exec/manager, but the
+  factorers are a pool of threads of this process sharing TData_t directly.
+*/
+
+#define _DEFAULT_SOURCE
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <definitions.h>
+#include <factor_cache.h>
+#include <semaphoreI.h>
+#include <tasks.h>
+
+/* Everything a factorer thread needs */
+struct TWorker_t {
+  pthread_t thread;
+  sem_t *sem_task_ready, *sem_task_read, *sem_task_processed;
+  struct TData_t *data;
+  struct TTask_t *task;
+};
+
+/* Thread management */
+void create_threads(struct TWorker_t *workers, int n_workers);
+void *factorer_thread(void *arg);
+void wait_threads(struct TWorker_t *workers, int n_workers);
+
+/* Auxiliar functions */
+void parse_argv(int argc, char *argv[], int *numerator, int *denominator);
+
+/******************** Main function ********************/
+
+int main(int argc, char *argv[]) {
+  struct TData_t *data;
+  struct TTask_t task;
+  struct TWorker_t *workers;
+  sem_t *sem_task_ready, *sem_task_read, *sem_task_processed;
+  struct TFactorCache_t *cache;
+  int numerator, denominator, n_workers, i;
+
+  parse_argv(argc, argv, &numerator, &denominator);
+
+  /* Private data and semaphores (no shared memory needed) */
+  if (posix_memalign((void **)&data, CACHE_LINE_SIZE, sizeof(struct TData_t)) != 0) {
+    fprintf(stderr, "[MANAGER] Error allocating data.\n");
+    exit(EXIT_FAILURE);
+  }
+  sem_task_ready = create_private_semaphore(0);
+  sem_task_read = create_private_semaphore(0);
+  sem_task_processed = create_private_semaphore(0);
+
+  /* Create the pool */
+  n_workers = get_pool_size();
+  workers = malloc(n_workers * sizeof(struct TWorker_t));
+  for (i = 0; i < n_workers; i++) {
+    workers[i].sem_task_ready = sem_task_ready;
+    workers[i].sem_task_read = sem_task_read;
+    workers[i].sem_task_processed = sem_task_processed;
+    workers[i].data = data;
+    workers[i].task = &task;
+  }
+  create_threads(workers, n_workers);
+
+  /* Manage tasks */
+  cache = open_factor_cache();
+  factor_fraction(sem_task_ready, sem_task_read, sem_task_processed,
+		  cache, data, &task, numerator, denominator);
+  close_factor_cache(cache);
+
+  /* Stop and wait for the pool */
+  notify_stop(sem_task_ready, sem_task_read, &task, n_workers);
+  wait_threads(workers, n_workers);
+
+  /* Print the obtained result */
+  print_result(data);
+
+  /* Free resources and terminate */
+  printf("\n----- [MANAGER] Freeing resources ----- \n");
+  remove_private_semaphore(sem_task_ready);
+  remove_private_semaphore(sem_task_read);
+  remove_private_semaphore(sem_task_processed);
+  free(workers);
+  free(data);
+
+  return EXIT_SUCCESS;
+}
+
+/******************** Thread management ********************/
+
+void create_threads(struct TWorker_t *workers, int n_workers) {
+  int i, error;
+
+  for (i = 0; i < n_workers; i++) {
+    if ((error = pthread_create(&workers[i].thread, NULL, factorer_thread, &workers[i])) != 0) {
+      fprintf(stderr, "[MANAGER] Error creating %s thread: %s.\n", FACTORER_CLASS, strerror(error));
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  printf("[MANAGER] %d %s threads created.\n", n_workers, FACTORER_CLASS);
+}
+
+void *factorer_thread(void *arg) {
+  struct TWorker_t *worker = arg;
+
+  /* Same logic as the FACTORER process, but looping until STOP_TASK */
+  while (get_and_process_task(worker->sem_task_ready, worker->sem_task_read,
+			      worker->data, worker->task)) {
+    notify_task_completed(worker->sem_task_processed);
+  }
+
+  return NULL;
+}
+
+void wait_threads(struct TWorker_t *workers, int n_workers) {
+  int i;
+
+  for (i = 0; i < n_workers; i++) {
+    pthread_join(workers[i].thread, NULL);
+  }
+}
+
+/******************** Auxiliar functions ********************/
+
+void parse_argv(int argc, char *argv[], int *numerator, int *denominator) {
+  if (argc != 3) {
+    fprintf(stderr, "Synopsis: ./exec/manager_threads <numerator> <denominator>.\n");
+    exit(EXIT_FAILURE);
+  }
+
+  *numerator = atoi(argv[1]);
+  *denominator = atoi(argv[2]);
+}
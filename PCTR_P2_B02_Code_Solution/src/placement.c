@@ -0,0 +1,106 @@
+/*
+====================================================================
+Concurrent and Real-Time Programming
+Faculty of Computer Science
+University of Castilla-La Mancha (Spain)
+
+Contact info: http://www.libropctr.com
+
+You can redistribute and/or modify this file under the terms of the
+GNU General Public License ad published by the Free Software
+Foundation, either version 3 of the License, or (at your option) and
+later version. See <http://www.gnu.org/licenses/>.
+
+This file is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+====================================================================
+*/
+
+#define _GNU_SOURCE
+
+#include <sched.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <placement.h>
+
+#define NODE_CPULIST "/sys/devices/system/node/node%d/cpulist"
+
+/* Auxiliar functions */
+int allowed_cpu(const cpu_set_t *allowed, int cpu);
+
+int get_memory_node(void *address) {
+  void *page;
+  int status = -1;
+
+  /* move_pages() without target nodes only reports where the page is */
+  page = (void *)((uintptr_t)address & ~((uintptr_t)sysconf(_SC_PAGESIZE) - 1));
+  if (syscall(SYS_move_pages, 0, 1UL, &page, NULL, &status, 0) == -1 || status < 0) {
+    return 0;
+  }
+
+  return status;
+}
+
+int get_node_cpus(int node, int *cpus, int max_cpus) {
+  char path[64];
+  cpu_set_t allowed;
+  FILE *cpulist;
+  int first, last, cpu, n_cpus = 0;
+
+  /* Only the cores this process may run on (taskset, cgroups) */
+  if (sched_getaffinity(0, sizeof(cpu_set_t), &allowed) == -1) {
+    CPU_ZERO(&allowed);
+  }
+
+  snprintf(path, sizeof(path), NODE_CPULIST, node);
+  if ((cpulist = fopen(path, "r")) != NULL) {
+    /* Ranges such as "0-3,8-11" */
+    while (fscanf(cpulist, "%d", &first) == 1) {
+      last = first;
+      if (fscanf(cpulist, "-%d", &last) < 0) {
+	break;
+      }
+      for (cpu = first; cpu <= last && n_cpus < max_cpus; cpu++) {
+	if (allowed_cpu(&allowed, cpu)) {
+	  cpus[n_cpus++] = cpu;
+	}
+      }
+      if (fgetc(cpulist) != ',') {
+	break;
+      }
+    }
+    fclose(cpulist);
+  }
+
+  /* No NUMA information (or no allowed core in the node): every allowed
+     core. None at all if the affinity mask could not be read */
+  if (n_cpus == 0) {
+    for (cpu = 0; cpu < CPU_SETSIZE && n_cpus < max_cpus; cpu++) {
+      if (CPU_ISSET(cpu, &allowed)) {
+	cpus[n_cpus++] = cpu;
+      }
+    }
+  }
+
+  return n_cpus;
+}
+
+int pin_process(pid_t pid, int cpu) {
+  cpu_set_t mask;
+
+  CPU_ZERO(&mask);
+  CPU_SET(cpu, &mask);
+
+  return sched_setaffinity(pid, sizeof(cpu_set_t), &mask) == 0;
+}
+
+/******************** Auxiliar functions ********************/
+
+int allowed_cpu(const cpu_set_t *allowed, int cpu) {
+  return cpu < CPU_SETSIZE && CPU_ISSET(cpu, allowed);
+}
@@ -0,0 +1,61 @@
+/*
+====================================================================
+Concurrent and Real-Time Programming
+Faculty of Computer Science
+University of Castilla-La Mancha (Spain)
+
+Contact info: http://www.libropctr.com
+
+You can redistribute and/or modify this file under the terms of the
+GNU General Public License ad published by the Free Software
+Foundation, either version 3 of the License, or (at your option) and
+later version. See <http://www.gnu.org/licenses/>.
+
+This file is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+====================================================================
+*/
+
+#include <errno.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <definitions.h>
+#include <protocol.h>
+
+int read_full(int fd, void *buffer, size_t size) {
+  ssize_t n;
+  size_t done = 0;
+
+  while (done < size) {
+    if ((n = read(fd, (char *)buffer + done, size - done)) == -1 && errno == EINTR) {
+      continue;
+    }
+    /* Error or peer closed the connection */
+    if (n <= 0) {
+      return FALSE;
+    }
+    done += n;
+  }
+
+  return TRUE;
+}
+
+int write_full(int fd, const void *buffer, size_t size) {
+  ssize_t n;
+  size_t done = 0;
+
+  while (done < size) {
+    if ((n = write(fd, (const char *)buffer + done, size - done)) == -1) {
+      if (errno == EINTR) {
+	continue;
+      }
+      return FALSE;
+    }
+    done += n;
+  }
+
+  return TRUE;
+}
@@ -0,0 +1,76 @@
+/*
+====================================================================
+Concurrent and Real-Time Programming
+Faculty of Computer Science
+University of Castilla-La Mancha (Spain)
+
+Contact info: http://www.libropctr.com
+
+You can redistribute and/or modify this file under the terms of the
+GNU General Public License ad published by the Free Software
+Foundation, either version 3 of the License, or (at your option) and
+later version. See <http://www.gnu.org/licenses/>.
+
+This file is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+====================================================================
+*/
+
+#include <arpa/inet.h>
+#include <stdint.h>
+
+#include <definitions.h>
+#include <protocol.h>
+#include <remote.h>
+
+int send_remote_task(int fd, const struct TRemoteTask_t *task) {
+  uint32_t fields[5];
+
+  fields[0] = htonl(task->numerator);
+  fields[1] = htonl(task->denominator);
+  fields[2] = htonl(task->prime_number);
+  fields[3] = htonl(task->task.first_position);
+  fields[4] = htonl(task->task.last_position);
+
+  return write_full(fd, fields, sizeof(fields));
+}
+
+int receive_remote_task(int fd, struct TRemoteTask_t *task) {
+  uint32_t fields[5];
+
+  if (!read_full(fd, fields, sizeof(fields))) {
+    return FALSE;
+  }
+  task->numerator = (int)ntohl(fields[0]);
+  task->denominator = (int)ntohl(fields[1]);
+  task->prime_number = (int)ntohl(fields[2]);
+  task->task.first_position = (int)ntohl(fields[3]);
+  task->task.last_position = (int)ntohl(fields[4]);
+
+  return TRUE;
+}
+
+int send_remote_result(int fd, const struct TRemoteResult_t *result) {
+  uint32_t fields[3];
+
+  fields[0] = htonl(result->prime_number_position);
+  fields[1] = htonl(result->numerator_exponent);
+  fields[2] = htonl(result->denominator_exponent);
+
+  return write_full(fd, fields, sizeof(fields));
+}
+
+int receive_remote_result(int fd, struct TRemoteResult_t *result) {
+  uint32_t fields[3];
+
+  if (!read_full(fd, fields, sizeof(fields))) {
+    return FALSE;
+  }
+  result->prime_number_position = (int)ntohl(fields[0]);
+  result->numerator_exponent = (int)ntohl(fields[1]);
+  result->denominator_exponent = (int)ntohl(fields[2]);
+
+  return TRUE;
+}
@@ -0,0 +1,162 @@
+/*
+====================================================================
+Concurrent and Real-Time Programming
+Faculty of Computer Science
+University of Castilla-La Mancha (Spain)
+
+Contact info: http://www.libropctr.com
+
+You can redistribute and/or modify this file under the terms of the
+GNU General Public License ad published by the Free Software
+Foundation, either version 3 of the License, or (at your option) and
+later version. See <http://www.gnu.org/licenses/>.
+
+This file is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+====================================================================
+*/
+
+/*
+  Worker of the distributed mode: attaches to a coordinator by address
+  and processes its tasks until the coordinator closes the connection.
+  Losses and slow workers can be simulated with DROP_PRIME_FLAG and
+  DELAY_FLAG.
+*/
+
+#define _DEFAULT_SOURCE
+
+#include <errno.h>
+#include <netdb.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <definitions.h>
+#include <divisibility.h>
+#include <remote.h>
+
+/* Coordinator access */
+int connect_to_coordinator(const char *host, const char *port);
+void process_task(const struct TRemoteTask_t *task, struct TRemoteResult_t *result);
+
+/* Auxiliar functions */
+void parse_argv(int argc, char *argv[], int *drop_prime, int *delay_ms);
+void sleep_ms(int delay_ms);
+
+/******************** Main function ********************/
+
+int main(int argc, char *argv[]) {
+  struct TRemoteTask_t task;
+  struct TRemoteResult_t result;
+  int fd, n_tasks = 0, drop_prime, delay_ms;
+
+  parse_argv(argc, argv, &drop_prime, &delay_ms);
+
+  /* A coordinator gone mid-write must not kill us: send fails instead */
+  signal(SIGPIPE, SIG_IGN);
+
+  fd = connect_to_coordinator(argv[1], argv[2]);
+  while (receive_remote_task(fd, &task)) {
+    /* Not a prime: 1 would never end the multiplicity() loop */
+    if (task.prime_number < 2) {
+      fprintf(stderr, "[WORKER %d] Invalid prime %d: hanging up.\n", getpid(), task.prime_number);
+      break;
+    }
+    if (task.prime_number == drop_prime) {
+      printf("[WORKER %d] Hanging up on prime %d.\n", getpid(), drop_prime);
+      break;
+    }
+    process_task(&task, &result);
+    sleep_ms(delay_ms);
+    if (!send_remote_result(fd, &result)) {
+      break;
+    }
+    n_tasks++;
+  }
+  close(fd);
+
+  printf("[WORKER %d] %d tasks processed.\n", getpid(), n_tasks);
+
+  return EXIT_SUCCESS;
+}
+
+/******************** Coordinator access ********************/
+
+int connect_to_coordinator(const char *host, const char *port) {
+  struct addrinfo hints, *addresses, *address;
+  int fd = -1;
+
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+
+  if (getaddrinfo(host, port, &hints, &addresses) != 0) {
+    fprintf(stderr, "[WORKER %d] Unknown coordinator %s:%s.\n", getpid(), host, port);
+    exit(EXIT_FAILURE);
+  }
+  for (address = addresses; address != NULL && fd == -1; address = address->ai_next) {
+    if ((fd = socket(address->ai_family, address->ai_socktype, address->ai_protocol)) != -1 &&
+	connect(fd, address->ai_addr, address->ai_addrlen) == -1) {
+      close(fd);
+      fd = -1;
+    }
+  }
+  freeaddrinfo(addresses);
+
+  if (fd == -1) {
+    fprintf(stderr, "[WORKER %d] Error connecting to %s:%s: %s.\n", getpid(), host, port, strerror(errno));
+    exit(EXIT_FAILURE);
+  }
+
+  return fd;
+}
+
+void process_task(const struct TRemoteTask_t *task, struct TRemoteResult_t *result) {
+  struct TDivisibilityTable_t table;
+  unsigned int quotient;
+  int prime = task->prime_number;
+
+  /* One inverse per task, shared by both numbers */
+  init_divisibility_table(&table, &prime, 1);
+  result->prime_number_position = task->task.first_position;
+  result->numerator_exponent = multiplicity(&table, 0, magnitude(task->numerator), &quotient);
+  result->denominator_exponent = multiplicity(&table, 0, magnitude(task->denominator), &quotient);
+}
+
+/******************** Auxiliar functions ********************/
+
+void parse_argv(int argc, char *argv[], int *drop_prime, int *delay_ms) {
+  int i;
+
+  *drop_prime = *delay_ms = 0;
+  for (i = 3; i + 1 < argc; i += 2) {
+    if (strcmp(argv[i], DROP_PRIME_FLAG) == 0) {
+      *drop_prime = atoi(argv[i + 1]);
+    } else if (strcmp(argv[i], DELAY_FLAG) == 0) {
+      *delay_ms = atoi(argv[i + 1]);
+    } else {
+      break;
+    }
+  }
+
+  if (argc < 3 || i != argc || *delay_ms < 0) {
+    fprintf(stderr, "Synopsis: ./exec/remote_worker <host> <port> [%s p] [%s ms].\n",
+	    DROP_PRIME_FLAG, DELAY_FLAG);
+    exit(EXIT_FAILURE);
+  }
+}
+
+void sleep_ms(int delay_ms) {
+  struct timespec delay;
+
+  delay.tv_sec = delay_ms / 1000;
+  delay.tv_nsec = (delay_ms % 1000) * 1000000L;
+  while (nanosleep(&delay, &delay) == -1 && errno == EINTR);
+}
@@ -26,6 +26,7 @@ General Public License for more details.
 #include <unistd.h>
 
 #include <semaphoreI.h>
+#include <semaphoreI_stats.h>
 
 sem_t *create_semaphore (const char *name, unsigned int value) {
   sem_t *sem;
@@ -34,6 +35,7 @@ sem_t *create_semaphore (const char *name, unsigned int value) {
     fprintf(stderr, "Error creating semaphore <%s>: %s\n", name, strerror(errno));
     exit(EXIT_FAILURE);
   }
+  stats_register(name, sem, 1);
 
   return sem;
 }
@@ -45,6 +47,7 @@ sem_t *get_semaphore (const char *name) {
     fprintf(stderr, "Error retrieving semaphore <%s>: %s\n", name, strerror(errno));
     exit(EXIT_FAILURE);
   }
+  stats_register(name, sem, 0);
 
   return sem;
 }
@@ -63,6 +66,25 @@ void remove_semaphore (const char *name) {
   }
 }
 
+sem_t *create_private_semaphore (unsigned int value) {
+  sem_t *sem;
+
+  if ((sem = malloc(sizeof(sem_t))) == NULL || sem_init(sem, 0, value) == -1) {
+    fprintf(stderr, "Error creating private semaphore: %s\n", strerror(errno));
+    exit(EXIT_FAILURE);
+  }
+
+  return sem;
+}
+
+void remove_private_semaphore (sem_t *sem) {
+  if ((sem_destroy(sem)) == -1) {
+    fprintf(stderr, "Error removing private semaphore: %s\n", strerror(errno));
+    exit(EXIT_FAILURE);
+  }
+  free(sem);
+}
+
 void signal_semaphore (sem_t *sem) {
   if ((sem_post(sem)) == -1) {
     fprintf(stderr, "Error incrementing the semaphore: %s\n", strerror(errno));
@@ -71,8 +93,11 @@ void signal_semaphore (sem_t *sem) {
 }
 
 void wait_semaphore (sem_t *sem) {
+  long long start_ns = stats_now();
+
   if ((sem_wait(sem)) == -1) {
     fprintf(stderr, "Error decrementing the semaphore: %s\n", strerror(errno));
     exit(EXIT_FAILURE);
   }
+  stats_record_wait(sem, start_ns);
 }
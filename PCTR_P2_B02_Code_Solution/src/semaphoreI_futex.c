@@ -0,0 +1,224 @@
+/*
+====================================================================
+Concurrent and Real-Time Programming
+Faculty of Computer Science
+University of Castilla-La Mancha (Spain)
+
+Contact info: http://www.libropctr.com
+
+You can redistribute and/or modify this file under the terms of the
+GNU General Public License ad published by the Free Software
+Foundation, either version 3 of the License, or (at your option) and
+later version. See <http://www.gnu.org/licenses/>.
+
+This file is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+====================================================================
+*/
+
+/*
+  Alternate backend of semaphoreI.h (make SEM_BACKEND=futex).
+
+  Each semaphore is a futex word living in its own shared memory object,
+  so waits and signals stay in user space unless a process really has to
+  block. The returned sem_t * is only used as an opaque handle: its
+  storage holds a TFutexSem_t instead of a glibc semaphore.
+*/
+
+#define _DEFAULT_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <semaphoreI.h>
+#include <semaphoreI_stats.h>
+
+#define SEM_SHM_PREFIX "semI."
+#define MIN_SPINS      16
+#define MAX_SPINS      4096
+
+#if defined(__x86_64__) || defined(__i386__)
+#define cpu_relax() __builtin_ia32_pause()
+#else
+#define cpu_relax() __asm__ __volatile__("" ::: "memory")
+#endif
+
+struct TFutexSem_t {
+  int value;   /* Futex word: number of available units */
+  int waiters; /* Processes sleeping (or about to sleep) on 'value' */
+  int spins;   /* Adaptive spin budget before blocking */
+};
+
+/* Shared memory handling */
+struct TFutexSem_t *map_semaphore(const char *name, int flags);
+void get_shm_name(const char *name, char *shm_name);
+
+/* Futex primitives */
+int futex_wait(int *uaddr, int val);
+int futex_wake(int *uaddr, int n);
+int try_decrement(struct TFutexSem_t *fsem);
+
+sem_t *create_semaphore (const char *name, unsigned int value) {
+  struct TFutexSem_t *fsem;
+
+  fsem = map_semaphore(name, O_CREAT | O_RDWR);
+  fsem->waiters = 0;
+  /* Spinning is pointless when the signaller cannot run meanwhile */
+  fsem->spins = (sysconf(_SC_NPROCESSORS_ONLN) > 1) ? MIN_SPINS : 0;
+  __atomic_store_n(&fsem->value, (int)value, __ATOMIC_SEQ_CST);
+  stats_register(name, (sem_t *)fsem, 1);
+
+  return (sem_t *)fsem;
+}
+
+sem_t *get_semaphore (const char *name) {
+  struct TFutexSem_t *fsem;
+
+  fsem = map_semaphore(name, O_RDWR);
+  stats_register(name, (sem_t *)fsem, 0);
+
+  return (sem_t *)fsem;
+}
+
+void remove_semaphore (const char *name) {
+  char shm_name[NAME_MAX];
+
+  get_shm_name(name, shm_name);
+  if (shm_unlink(shm_name) == -1) {
+    fprintf(stderr, "Error removing semaphore <%s>: %s\n", name, strerror(errno));
+    exit(EXIT_FAILURE);
+  }
+}
+
+sem_t *create_private_semaphore (unsigned int value) {
+  struct TFutexSem_t *fsem;
+
+  if ((fsem = malloc(sizeof(struct TFutexSem_t))) == NULL) {
+    fprintf(stderr, "Error creating private semaphore: %s\n", strerror(errno));
+    exit(EXIT_FAILURE);
+  }
+  fsem->value = value;
+  fsem->waiters = 0;
+  fsem->spins = (sysconf(_SC_NPROCESSORS_ONLN) > 1) ? MIN_SPINS : 0;
+
+  return (sem_t *)fsem;
+}
+
+void remove_private_semaphore (sem_t *sem) {
+  free(sem);
+}
+
+void signal_semaphore (sem_t *sem) {
+  struct TFutexSem_t *fsem = (struct TFutexSem_t *)sem;
+
+  __atomic_add_fetch(&fsem->value, 1, __ATOMIC_SEQ_CST);
+
+  /* Only enter the kernel when someone may be sleeping */
+  if (__atomic_load_n(&fsem->waiters, __ATOMIC_SEQ_CST) > 0) {
+    if (futex_wake(&fsem->value, 1) == -1) {
+      fprintf(stderr, "Error incrementing the semaphore: %s\n", strerror(errno));
+      exit(EXIT_FAILURE);
+    }
+  }
+}
+
+void wait_semaphore (sem_t *sem) {
+  struct TFutexSem_t *fsem = (struct TFutexSem_t *)sem;
+  long long start_ns = stats_now();
+  int i, spins;
+
+  /* Spin phase: the budget grows when spinning pays off and shrinks otherwise */
+  spins = __atomic_load_n(&fsem->spins, __ATOMIC_RELAXED);
+  for (i = 0; i < spins; i++) {
+    if (try_decrement(fsem)) {
+      if (spins < MAX_SPINS) {
+	__atomic_store_n(&fsem->spins, spins * 2, __ATOMIC_RELAXED);
+      }
+      stats_record_wait(sem, start_ns);
+      return;
+    }
+    cpu_relax();
+  }
+  if (spins > MIN_SPINS) {
+    __atomic_store_n(&fsem->spins, spins / 2, __ATOMIC_RELAXED);
+  }
+
+  /* Block phase: announce ourselves before re-checking the value */
+  __atomic_add_fetch(&fsem->waiters, 1, __ATOMIC_SEQ_CST);
+  while (!try_decrement(fsem)) {
+    if (futex_wait(&fsem->value, 0) == -1 && errno != EAGAIN && errno != EINTR) {
+      fprintf(stderr, "Error decrementing the semaphore: %s\n", strerror(errno));
+      exit(EXIT_FAILURE);
+    }
+  }
+  __atomic_sub_fetch(&fsem->waiters, 1, __ATOMIC_SEQ_CST);
+  stats_record_wait(sem, start_ns);
+}
+
+/******************** Shared memory handling ********************/
+
+struct TFutexSem_t *map_semaphore(const char *name, int flags) {
+  char shm_name[NAME_MAX];
+  struct TFutexSem_t *fsem;
+  int fd;
+
+  get_shm_name(name, shm_name);
+
+  if ((fd = shm_open(shm_name, flags, 0644)) == -1) {
+    fprintf(stderr, "Error %s semaphore <%s>: %s\n",
+	    (flags & O_CREAT) ? "creating" : "retrieving", name, strerror(errno));
+    exit(EXIT_FAILURE);
+  }
+  if ((flags & O_CREAT) && ftruncate(fd, sizeof(struct TFutexSem_t)) == -1) {
+    fprintf(stderr, "Error creating semaphore <%s>: %s\n", name, strerror(errno));
+    exit(EXIT_FAILURE);
+  }
+
+  fsem = mmap(NULL, sizeof(struct TFutexSem_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (fsem == MAP_FAILED) {
+    fprintf(stderr, "Error mapping semaphore <%s>: %s\n", name, strerror(errno));
+    exit(EXIT_FAILURE);
+  }
+
+  return fsem;
+}
+
+void get_shm_name(const char *name, char *shm_name) {
+  snprintf(shm_name, NAME_MAX, "%s%s", SEM_SHM_PREFIX, name);
+}
+
+/******************** Futex primitives ********************/
+
+int futex_wait(int *uaddr, int val) {
+  /* Shared (non-private) futex: waiters live in different processes */
+  return syscall(SYS_futex, uaddr, FUTEX_WAIT, val, NULL, NULL, 0);
+}
+
+int futex_wake(int *uaddr, int n) {
+  return syscall(SYS_futex, uaddr, FUTEX_WAKE, n, NULL, NULL, 0);
+}
+
+int try_decrement(struct TFutexSem_t *fsem) {
+  int value = __atomic_load_n(&fsem->value, __ATOMIC_SEQ_CST);
+
+  while (value > 0) {
+    if (__atomic_compare_exchange_n(&fsem->value, &value, value - 1, 0,
+				    __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST)) {
+      return 1;
+    }
+  }
+
+  return 0;
+}
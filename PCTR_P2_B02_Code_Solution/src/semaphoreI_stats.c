@@ -0,0 +1,217 @@
+/*
+====================================================================
+Concurrent and Real-Time Programming
+Faculty of Computer Science
+University of Castilla-La Mancha (Spain)
+
+Contact info: http://www.libropctr.com
+
+You can redistribute and/or modify this file under the terms of the
+GNU General Public License ad published by the Free Software
+Foundation, either version 3 of the License, or (at your option) and
+later version. See <http://www.gnu.org/licenses/>.
+
+This file is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+====================================================================
+*/
+
+#define _DEFAULT_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <semaphoreI.h>
+#include <semaphoreI_stats.h>
+
+#ifdef SEMAPHOREI_STATS
+
+/* Stats segment shared by every process of one instance */
+static struct TSemStats_t *g_stats = NULL;
+static char g_stats_name[SEM_STATS_NAME + sizeof(SHM_SEM_STATS)] = SHM_SEM_STATS;
+
+/* Semaphores opened by this process and their slot in g_stats */
+static sem_t *g_sems[MAX_SEM_STATS];
+static int g_sem_slots[MAX_SEM_STATS];
+static int g_nSems = 0;
+
+/* Auxiliar functions */
+int attach_stats(int create);
+int claim_slot(const char *name, int create);
+int get_bucket(unsigned long ns);
+
+void name_semaphore_stats(const char *instance) {
+  snprintf(g_stats_name, sizeof(g_stats_name), "%s.%s", SHM_SEM_STATS, instance);
+}
+
+long long stats_now(void) {
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+void stats_register(const char *name, sem_t *sem, int create) {
+  int slot;
+
+  if (!attach_stats(create) || g_nSems == MAX_SEM_STATS) {
+    return;
+  }
+  if ((slot = claim_slot(name, create)) == -1) {
+    return;
+  }
+
+  g_sems[g_nSems] = sem;
+  g_sem_slots[g_nSems] = slot;
+  g_nSems++;
+}
+
+void stats_record_wait(sem_t *sem, long long start_ns) {
+  struct TSemStats_t *stats;
+  unsigned long ns, max_ns;
+  int i;
+
+  ns = stats_now() - start_ns;
+
+  for (i = 0; i < g_nSems && g_sems[i] != sem; i++);
+  if (i == g_nSems) {
+    return;
+  }
+  stats = &g_stats[g_sem_slots[i]];
+
+  __atomic_add_fetch(&stats->n_waits, 1, __ATOMIC_RELAXED);
+  __atomic_add_fetch(&stats->total_ns, ns, __ATOMIC_RELAXED);
+  __atomic_add_fetch(&stats->histogram[get_bucket(ns)], 1, __ATOMIC_RELAXED);
+
+  max_ns = __atomic_load_n(&stats->max_ns, __ATOMIC_RELAXED);
+  while (ns > max_ns &&
+	 !__atomic_compare_exchange_n(&stats->max_ns, &max_ns, ns, 0,
+				      __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+}
+
+void print_semaphore_stats() {
+  struct TSemStats_t *stats;
+  int i, j;
+
+  if (!attach_stats(0)) {
+    return;
+  }
+
+  printf("\n----- [MANAGER] Semaphore statistics ----- \n");
+  for (i = 0; i < MAX_SEM_STATS; i++) {
+    stats = &g_stats[i];
+    if (stats->used != 1) {
+      continue;
+    }
+    printf("%-30s %8lu waits  total %10.1f us  max %9.1f us\n", stats->name, stats->n_waits,
+	   stats->total_ns / 1e3, stats->max_ns / 1e3);
+    for (j = 0; j < SEM_STATS_BUCKETS; j++) {
+      if (stats->histogram[j] > 0) {
+	printf("%20s [2^%02d, 2^%02d) ns: %lu\n", "", j, j + 1, stats->histogram[j]);
+      }
+    }
+  }
+}
+
+void remove_semaphore_stats() {
+  if (g_stats != NULL) {
+    munmap(g_stats, MAX_SEM_STATS * sizeof(struct TSemStats_t));
+    g_stats = NULL;
+  }
+  shm_unlink(g_stats_name);
+}
+
+/******************** Auxiliar functions ********************/
+
+int attach_stats(int create) {
+  size_t size = MAX_SEM_STATS * sizeof(struct TSemStats_t);
+  int fd;
+
+  if (g_stats != NULL) {
+    return 1;
+  }
+
+  if ((fd = shm_open(g_stats_name, create ? (O_CREAT | O_RDWR) : O_RDWR, 0644)) == -1) {
+    fprintf(stderr, "Error opening semaphore statistics: %s\n", strerror(errno));
+    return 0;
+  }
+  /* A new segment is zero-filled */
+  if (create && ftruncate(fd, size) == -1) {
+    fprintf(stderr, "Error sizing semaphore statistics: %s\n", strerror(errno));
+    close(fd);
+    return 0;
+  }
+
+  g_stats = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (g_stats == MAP_FAILED) {
+    g_stats = NULL;
+    return 0;
+  }
+
+  return 1;
+}
+
+int claim_slot(const char *name, int create) {
+  int i, free_slot;
+
+  /* Semaphores are created before anyone retrieves them */
+  for (i = 0; i < MAX_SEM_STATS; i++) {
+    if (__atomic_load_n(&g_stats[i].used, __ATOMIC_ACQUIRE) == 1 &&
+	strncmp(g_stats[i].name, name, SEM_STATS_NAME) == 0) {
+      return i;
+    }
+  }
+  if (!create) {
+    return -1;
+  }
+
+  for (i = 0; i < MAX_SEM_STATS; i++) {
+    free_slot = 0;
+    /* -1 while being written: neither claimable nor visible. 'used' is
+       not cleared with the rest, or the slot could be claimed twice */
+    if (__atomic_compare_exchange_n(&g_stats[i].used, &free_slot, -1, 0,
+				    __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+      memset(g_stats[i].name, 0, sizeof(struct TSemStats_t) - offsetof(struct TSemStats_t, name));
+      strncpy(g_stats[i].name, name, SEM_STATS_NAME - 1);
+      __atomic_store_n(&g_stats[i].used, 1, __ATOMIC_RELEASE);
+      return i;
+    }
+  }
+
+  return -1;
+}
+
+int get_bucket(unsigned long ns) {
+  int bucket = 0;
+
+  while (ns > 1 && bucket < SEM_STATS_BUCKETS - 1) {
+    ns >>= 1;
+    bucket++;
+  }
+
+  return bucket;
+}
+
+#else
+
+void name_semaphore_stats(const char *instance) {
+}
+
+void print_semaphore_stats() {
+}
+
+void remove_semaphore_stats() {
+}
+
+#endif
@@ -0,0 +1,442 @@
+/*
+====================================================================
+Concurrent and Real-Time Programming
+Faculty of Computer Science
+University of Castilla-La Mancha (Spain)
+
+Contact info: http://www.libropctr.com
+
+You can redistribute and/or modify this file under the terms of the
+GNU General Public License ad published by the Free Software
+Foundation, either version 3 of the License, or (at your option) and
+later version. See <http://www.gnu.org/licenses/>.
+
+This file is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+====================================================================
+*/
+
+#define _DEFAULT_SOURCE
+
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <definitions.h>
+#include <divisibility.h>
+#include <factor_cache.h>
+#include <semaphoreI.h>
+#include <tasks.h>
+
+/* First n prime numbers */
+int g_primes[] = {
+  2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47, 53, 59, 61, 67,
+  71, 73, 79, 83, 89, 97, 101, 103, 107, 109, 113, 127, 131, 137, 139, 149, 151, 157,
+  163, 167, 173, 179, 181, 191, 193, 197, 199, 211, 223, 227, 229, 233, 239, 241, 251,
+  257, 263, 269, 271, 277, 281, 283, 293, 307, 311, 313, 317, 331, 337, 347, 349, 353,
+  359, 367, 373, 379, 383, 389, 397, 401, 409, 419, 421, 431, 433, 439, 443, 449, 457,
+  461, 463, 467, 479, 487, 491, 499, 503, 509, 521, 523, 541, 547
+};
+
+/* Inverses and limits of g_primes (see init_prime_divisibility()) */
+struct TDivisibilityTable_t g_divisibility;
+
+/* Progress messages (turned off by the daemon) */
+int g_verbose = TRUE;
+int g_chunk_size = CHUNK_GUIDED;
+
+/* Auxiliar functions */
+void collect_factors(struct TData_t *data, int numerator_side, struct TFactors_t *factors);
+int divide_out(int *cofactor, int position);
+int fully_factored(int cofactor, int prime);
+int get_candidate_positions(struct TData_t *data, int n_tasks, int *positions);
+int get_chunk_size(int n_remaining);
+int get_prime_position(int prime);
+void mark_candidate_primes(struct TData_t *data, int n_tasks, int *candidates);
+void init_prime_divisibility() __attribute__((constructor));
+
+/******************** IPC naming ********************/
+
+int get_ipc_names(const char *instance, struct TIpcNames_t *names) {
+  const char *it;
+
+  /* The instance becomes part of object names: keep it short and plain */
+  if (strlen(instance) == 0 || strlen(instance) >= MAX_INSTANCE_SIZE) {
+    return FALSE;
+  }
+  for (it = instance; *it; it++) {
+    if (!isalnum((unsigned char)*it) && *it != '_' && *it != '-') {
+      return FALSE;
+    }
+  }
+
+  strcpy(names->instance, instance);
+  snprintf(names->sem_task_ready, IPC_NAME_SIZE, "%s.%s", SEM_TASK_READY, instance);
+  snprintf(names->sem_task_read, IPC_NAME_SIZE, "%s.%s", SEM_TASK_READ, instance);
+  snprintf(names->sem_task_processed, IPC_NAME_SIZE, "%s.%s", SEM_TASK_PROCESSED, instance);
+  snprintf(names->shm_arena, IPC_NAME_SIZE, "%s.%s", SHM_ARENA, instance);
+
+  return TRUE;
+}
+
+/******************** Manager side ********************/
+
+int factor_fraction(sem_t *sem_task_ready, sem_t *sem_task_read, sem_t *sem_task_processed,
+		    struct TFactorCache_t *cache, struct TData_t *data, struct TTask_t *task,
+		    int numerator, int denominator) {
+  int cached;
+
+  cached = prepare_fraction(cache, data, numerator, denominator);
+  return complete_fraction(sem_task_ready, sem_task_read, sem_task_processed, cache, data, task, cached);
+}
+
+int prepare_fraction(struct TFactorCache_t *cache, struct TData_t *data, int numerator, int denominator) {
+  /* Tasks are only needed for the sides not found in the factor cache */
+  init_data(data, numerator, denominator, N_PRIME_NUMBERS);
+  return apply_cached_factors(cache, data);
+}
+
+int complete_fraction(sem_t *sem_task_ready, sem_t *sem_task_read, sem_t *sem_task_processed,
+		      struct TFactorCache_t *cache, struct TData_t *data, struct TTask_t *task, int cached) {
+  int n_tasks;
+
+  n_tasks = notify_tasks(sem_task_ready, sem_task_read, data, task, N_PRIME_NUMBERS);
+  wait_tasks_termination(sem_task_processed, n_tasks);
+  add_remaining_cofactors(data);
+  cache_computed_factors(cache, data, cached);
+  merge_results(data, N_PRIME_NUMBERS);
+
+  return n_tasks;
+}
+
+int get_pool_size() {
+  static int pool_size = 0;
+  long n_cpus;
+
+  /* One looping worker per online CPU (read once: it is a sysfs read) */
+  if (pool_size == 0) {
+    n_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    pool_size = (n_cpus < 1) ? 1 : (n_cpus < N_PRIME_NUMBERS) ? (int)n_cpus : N_PRIME_NUMBERS;
+  }
+  return pool_size;
+}
+
+void init_data(struct TData_t *data, int numerator, int denominator, int n_prime_numbers) {
+  int i;
+
+  data->numerator = numerator;
+  data->denominator = denominator;
+  data->numerator_cofactor = numerator;
+  data->denominator_cofactor = denominator;
+  for (i = 0; i < n_prime_numbers; i++) {
+    data->numerator_exponents[i] = 0;
+    data->denominator_exponents[i] = 0;
+    data->results[i].numerator_exponent = 0;
+    data->results[i].denominator_exponent = 0;
+  }
+}
+
+int count_tasks(struct TData_t *data, int n_tasks) {
+  int positions[N_PRIME_NUMBERS];
+  int first, n_positions, n_planned = 0;
+
+  /* What notify_tasks() would dispatch if no task ended the factoring early */
+  n_positions = get_candidate_positions(data, n_tasks, positions);
+  for (first = 0; first < n_positions; first += get_chunk_size(n_positions - first)) {
+    n_planned++;
+  }
+
+  return n_planned;
+}
+
+int notify_tasks(sem_t *sem_task_ready, sem_t *sem_task_read,
+		 struct TData_t *data, struct TTask_t *task, int n_tasks) {
+  int positions[N_PRIME_NUMBERS];
+  int first, chunk, n_positions, n_dispatched = 0;
+
+  n_positions = get_candidate_positions(data, n_tasks, positions);
+
+  for (first = 0; first < n_positions; first += chunk) {
+    /* Stop when no remaining prime can divide what is left */
+    if (fully_factored(__atomic_load_n(&data->numerator_cofactor, __ATOMIC_ACQUIRE), g_primes[positions[first]]) &&
+	fully_factored(__atomic_load_n(&data->denominator_cofactor, __ATOMIC_ACQUIRE), g_primes[positions[first]])) {
+      break;
+    }
+    chunk = get_chunk_size(n_positions - first);
+
+    /* Contiguous range: the non-candidates inside cost one test each */
+    task->first_position = positions[first];
+    task->last_position = positions[first + chunk - 1] + 1;
+    /* Task notification through rendezvous */
+    signal_semaphore(sem_task_ready);
+    wait_semaphore(sem_task_read);
+    n_dispatched++;
+  }
+
+  if (g_verbose) {
+    printf("[MANAGER] %d tasks dispatched for %d candidate primes.\n", n_dispatched, n_positions);
+  }
+  return n_dispatched;
+}
+
+void notify_stop(sem_t *sem_task_ready, sem_t *sem_task_read, struct TTask_t *task, int n_workers) {
+  int i;
+
+  /* One STOP_TASK task per looping worker */
+  for (i = 0; i < n_workers; i++) {
+    task->first_position = STOP_TASK;
+    task->last_position = STOP_TASK;
+    signal_semaphore(sem_task_ready);
+    wait_semaphore(sem_task_read);
+  }
+}
+
+void wait_tasks_termination(sem_t *sem_task_processed, int n_tasks) {
+ int n_tasks_processed = 0;
+
+  while (n_tasks_processed < n_tasks) {
+    wait_semaphore(sem_task_processed);                         
+    n_tasks_processed++;   
+  }
+}
+
+void add_remaining_cofactors(struct TData_t *data) {
+  int position;
+
+  /* Any cofactor left at this point is 1 or a prime never dispatched */
+  if ((position = get_prime_position(data->numerator_cofactor)) != -1) {
+    data->results[position].numerator_exponent++;
+    data->numerator_cofactor = 1;
+  }
+  if ((position = get_prime_position(data->denominator_cofactor)) != -1) {
+    data->results[position].denominator_exponent++;
+    data->denominator_cofactor = 1;
+  }
+}
+
+int apply_cached_factors(struct TFactorCache_t *cache, struct TData_t *data) {
+  struct TFactors_t factors;
+  int i, cached = 0;
+
+  /* A cached side needs no task: its cofactor is already 1 */
+  if (lookup_factors(cache, data->numerator, &factors)) {
+    for (i = 0; i < factors.n_factors; i++) {
+      data->results[factors.positions[i]].numerator_exponent = factors.exponents[i];
+    }
+    data->numerator_cofactor = 1;
+    cached |= CACHED_NUMERATOR;
+  }
+  if (lookup_factors(cache, data->denominator, &factors)) {
+    for (i = 0; i < factors.n_factors; i++) {
+      data->results[factors.positions[i]].denominator_exponent = factors.exponents[i];
+    }
+    data->denominator_cofactor = 1;
+    cached |= CACHED_DENOMINATOR;
+  }
+
+  if (cached && g_verbose) {
+    printf("[MANAGER] Factor cache hit for the %s.\n",
+	   (cached == CACHED_NUMERATOR) ? "numerator" :
+	   (cached == CACHED_DENOMINATOR) ? "denominator" : "numerator and denominator");
+  }
+  return cached;
+}
+
+void cache_computed_factors(struct TFactorCache_t *cache, struct TData_t *data, int cached) {
+  struct TFactors_t factors;
+
+  /* Only complete factorizations within the prime table are stored */
+  if (!(cached & CACHED_NUMERATOR) && magnitude(data->numerator_cofactor) == 1) {
+    collect_factors(data, TRUE, &factors);
+    store_factors(cache, data->numerator, &factors);
+  }
+  if (!(cached & CACHED_DENOMINATOR) && magnitude(data->denominator_cofactor) == 1) {
+    collect_factors(data, FALSE, &factors);
+    store_factors(cache, data->denominator, &factors);
+  }
+}
+
+void merge_results(struct TData_t *data, int n_tasks) {
+  int i;
+  int difference;
+
+  /* Gather the per-task slots into the (reduced) exponent vectors */
+  for (i = 0; i < n_tasks; i++) {
+    difference = data->results[i].numerator_exponent - data->results[i].denominator_exponent;
+    data->numerator_exponents[i] = (difference > 0) ? difference : 0;
+    data->denominator_exponents[i] = (difference < 0) ? -difference : 0;
+  }
+}
+
+void print_result(struct TData_t *data) {
+  int i, n_prime_numbers;
+
+  n_prime_numbers = sizeof(g_primes) / sizeof(g_primes[0]);
+
+  printf("\nResult: ( ");
+  for (i = 0; i < n_prime_numbers; i++) {
+    if (data->numerator_exponents[i] > 0) {
+      printf("%d^%d ", g_primes[i], data->numerator_exponents[i]);
+    }
+  }
+  printf(")/( ");
+  for (i = 0; i < n_prime_numbers; i++) {
+    if (data->denominator_exponents[i] > 0) {
+      printf("%d^%d ", g_primes[i], data->denominator_exponents[i]);
+    }
+  }
+  printf(")\n");
+}
+
+/******************** Worker side ********************/
+
+int get_and_process_task(sem_t *sem_task_ready, sem_t *sem_task_read, struct TData_t *data, const struct TTask_t *task){
+  
+  int first_position, last_position, position, xnumerator, xdenominator;
+  struct TResult_t *result;
+ 
+  wait_semaphore(sem_task_ready);
+  first_position = task->first_position;
+  last_position = task->last_position;
+  signal_semaphore(sem_task_read);
+
+  /* No more tasks for this worker */
+  if (first_position == STOP_TASK) {
+    return FALSE;
+  }
+
+  for (position = first_position; position < last_position; position++) {
+    /* Only this task writes the slots of its range (see TResult_t) */
+    result = &data->results[position];
+
+    /* Work on what is left of each number, not on the original values */
+    xnumerator = divide_out(&data->numerator_cofactor, position);
+    xdenominator = divide_out(&data->denominator_cofactor, position);
+
+    /* Raw exponents (merge_results() reduces the fraction). A side taken
+       from the factor cache already holds its exponent here */
+    result->numerator_exponent += xnumerator;
+    result->denominator_exponent += xdenominator;
+  }
+
+  return TRUE;
+}
+
+void notify_task_completed(sem_t *sem_task_processed){
+  signal_semaphore(sem_task_processed);
+}
+
+/******************** Auxiliar functions ********************/
+
+void collect_factors(struct TData_t *data, int numerator_side, struct TFactors_t *factors) {
+  int i, exponent;
+
+  factors->n_factors = 0;
+  for (i = 0; i < N_PRIME_NUMBERS && factors->n_factors < MAX_CACHED_FACTORS; i++) {
+    exponent = numerator_side ? data->results[i].numerator_exponent : data->results[i].denominator_exponent;
+    if (exponent > 0) {
+      factors->positions[factors->n_factors] = i;
+      factors->exponents[factors->n_factors] = exponent;
+      factors->n_factors++;
+    }
+  }
+}
+
+int divide_out(int *cofactor, int position) {
+  unsigned int quotient;
+  int current, reduced, times;
+
+  /* Division-free test; returns at once if 'prime' does not divide it */
+  current = __atomic_load_n(cofactor, __ATOMIC_ACQUIRE);
+  if ((times = multiplicity(&g_divisibility, position, magnitude(current), &quotient)) == 0) {
+    return 0;
+  }
+
+  /* Only this task divides by this prime, so its multiplicity cannot change.
+     Other tasks may be dividing the cofactor concurrently */
+  do {
+    reduced = exact_divide(&g_divisibility, position, current, times);
+  } while (!__atomic_compare_exchange_n(cofactor, &current, reduced, 0,
+					__ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+
+  return times;
+}
+
+int fully_factored(int cofactor, int prime) {
+  /* A cofactor below prime^2 with no smaller factors is 1 or a prime */
+  return cofactor == 1 || (cofactor > 0 && (long long)prime * prime > cofactor);
+}
+
+int get_candidate_positions(struct TData_t *data, int n_tasks, int *positions) {
+  int candidates[N_PRIME_NUMBERS];
+  int i, n_positions = 0;
+
+  /* Only primes dividing either number are worth a task */
+  mark_candidate_primes(data, n_tasks, candidates);
+  for (i = 0; i < n_tasks; i++) {
+    if (candidates[i]) {
+      positions[n_positions++] = i;
+    }
+  }
+
+  return n_positions;
+}
+
+int get_chunk_size(int n_remaining) {
+  int chunk, n_workers;
+
+  if (g_chunk_size != CHUNK_GUIDED) {
+    return (g_chunk_size < n_remaining) ? g_chunk_size : n_remaining;
+  }
+
+  /* Guided: half of an even share of what is left per worker. The first
+     chunks amortize the rendezvous, the last ones balance the tail */
+  n_workers = get_pool_size();
+  chunk = (n_remaining + 2 * n_workers - 1) / (2 * n_workers);
+  return (chunk > 0) ? chunk : 1;
+}
+
+int get_prime_position(int prime) {
+  int i, n_prime_numbers;
+
+  n_prime_numbers = sizeof(g_primes) / sizeof(g_primes[0]);
+
+  for (i = 0; i < n_prime_numbers; i++) {
+    if (g_primes[i] == prime) {
+      return i;
+    }
+  }
+
+  return -1;
+}
+
+void mark_candidate_primes(struct TData_t *data, int n_tasks, int *candidates) {
+  int positions[N_PRIME_NUMBERS];
+  int i, n_positions;
+
+  /* Sweep the whole prime table for both numbers; only the first n_tasks
+     primes get a task */
+  memset(candidates, 0, n_tasks * sizeof(int));
+
+  n_positions = find_prime_divisors(&g_divisibility, magnitude(data->numerator_cofactor), positions);
+  for (i = 0; i < n_positions; i++) {
+    if (positions[i] < n_tasks) {
+      candidates[positions[i]] = 1;
+    }
+  }
+  n_positions = find_prime_divisors(&g_divisibility, magnitude(data->denominator_cofactor), positions);
+  for (i = 0; i < n_positions; i++) {
+    if (positions[i] < n_tasks) {
+      candidates[positions[i]] = 1;
+    }
+  }
+}
+
+void init_prime_divisibility() {
+  /* Before main(): every engine, threads included, finds it ready */
+  init_divisibility_table(&g_divisibility, g_primes, N_PRIME_NUMBERS);
+}
@@ -21,8 +21,8 @@ General Public License for more details.
 #define MQ_LINES         "/mq_lines"
 #define MQ_RESULTS       "/mq_results"
 #define MQ_WORDS         "/mq_words"
-#define MQ_NUMBER_DIGITS "/mq_number_digits"
-#define MQ_MUTEX         "/mq_mutex"
+#define MQ_NUMBER_DIGITS "/mq_number_digits" /* One reply queue per processor: "<name>.<id>" */
+#define MQ_NAME_SIZE     64
 
 #define PROCESSOR_CLASS   "PROCESSOR"
 #define PROCESSOR_PATH    "./exec/processor"
@@ -30,19 +30,82 @@ General Public License for more details.
 #define COUNTER_PATH      "./exec/counter"
 
 #define MAX_LINE_SIZE 255
-#define NUM_COUNTERS 1
+#define MAX_WORDS_PER_LINE (MAX_LINE_SIZE / 2 + 1)
+#define MAX_PROCESSORS 64
+#define DEFAULT_COUNTERS 1
+#define INLINE_FLAG "--inline" /* Processors count digits themselves (0 counters) */
+#define PATTERN_SEPARATOR "," /* <pattern>: "<p1>,<p2>,..." counted in one pass */
+#define MAX_PATTERNS 64
+#define MAX_PATTERN_SIZE (MAX_LINE_SIZE / 2) /* Bytes of the longest pattern */
+
+/* Elastic pool (n_processors given as <min>-<max>) */
+#define SCALE_INTERVAL_MS  200 /* MQ_LINES depth sampling period */
+#define SCALE_IDLE_SAMPLES 5   /* Empty samples in a row before retiring a processor */
+#define POISON_PILL        -1  /* MsgLine_t length that retires the processor taking it */
+#define PROGRESS_INTERVAL_MS 1000 /* Period of the manager's running totals */
+
+/* Per-line records, in input order (stdout by default) */
+#define RECORDS_FLAG "--records" /* <path>: write them to a file */
+#define BINARY_FLAG  "--binary"  /* As TLineRecord_t instead of text */
 #define WORD_SEPARATOR " "
 #define TRUE 1
 #define FALSE 0
 
-/* Used in MQ_LINES */
+/* Used in MQ_LINES: a line, or a chunk of it cut at a word boundary when
+   longer than MAX_LINE_SIZE. A longer word is cut inside and each chunk
+   that continues it starts with its first 'head' bytes again: they only
+   decide the patterns the word matches, and neither the word nor their
+   digits are counted twice. Only the used part of 'line' is sent (the
+   pattern reaches processors once, in their command line) */
 struct MsgLine_t {
-  char line[MAX_LINE_SIZE];
-  char pattern[MAX_LINE_SIZE];
+  int task_id;     /* Sequence number of the task (chunk) */
+  int line_number; /* Input line it belongs to (from 1) */
+  int head;        /* Repeated bytes of a continued word, or 0 */
+  int length;      /* Head included */
+  char line[MAX_LINE_SIZE + 1];
+};
+#define MSG_LINE_SIZE(msg) (offsetof(struct MsgLine_t, line) + (msg)->length)
+
+/* Used in MQ_WORDS: every matching word of a line, each one preceded by
+   its length byte. Only the used part of 'words' is sent. The reply goes
+   to the queue of processor reply_id */
+struct MsgWords_t {
+  int reply_id;
+  int n_words;
+  int length;
+  unsigned char words[MAX_LINE_SIZE + 1];
+};
+#define MSG_WORDS_SIZE(msg) (offsetof(struct MsgWords_t, words) + (msg)->length)
+
+/* Used in MQ_NUMBER_DIGITS.<id>: digits of each word of the request */
+struct MsgDigits_t {
+  int n_words;
+  int n_digits[MAX_WORDS_PER_LINE];
 };
+#define MSG_DIGITS_SIZE(msg) (offsetof(struct MsgDigits_t, n_digits) + (msg)->n_words * sizeof(int))
 
-/* Used in MQ_RESULTS */
+/* Words and digits of one pattern of the list */
+struct TPatternCount_t {
+  int n_words;
+  int n_digits;
+};
+
+/* Used in MQ_RESULTS (ids copied from the MsgLine_t). n_words and n_digits
+   count every matching word once, counts[i] belongs to pattern i. Only
+   the counts of the n_patterns patterns are sent */
 struct MsgResult_t {
+  int task_id;
+  int line_number;
+  int n_words;
+  int n_digits;
+  int n_patterns;
+  struct TPatternCount_t counts[MAX_PATTERNS];
+};
+#define MSG_RESULT_SIZE(msg) (offsetof(struct MsgResult_t, counts) + (msg)->n_patterns * sizeof(struct TPatternCount_t))
+
+/* Record of --records --binary, one per input line (host byte order) */
+struct TLineRecord_t {
+  int line_number;
   int n_words;
   int n_digits;
 };
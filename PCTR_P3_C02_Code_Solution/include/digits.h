@@ -0,0 +1,35 @@
+/*
+====================================================================
+Concurrent and Real-Time Programming
+Faculty of Computer Science
+University of Castilla-La Mancha (Spain)
+
+Contact info: http://www.libropctr.com
+
+You can redistribute and/or modify this file under the terms of the
+GNU General Public License ad published by the Free Software
+Foundation, either version 3 of the License, or (at your option) and
+later version. See <http://www.gnu.org/licenses/>.
+
+This file is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+====================================================================
+*/
+
+#ifndef __DIGITS_H__
+#define __DIGITS_H__
+
+/*
+  Digit counting kernel shared by COUNTER processes and by processors
+  running inline. Blocks of DIGITS_BLOCK bytes are range-compared against
+  '0'..'9' with vector operations and the matching lanes are popcounted;
+  the tail of the word is counted one byte at a time.
+*/
+
+#define DIGITS_BLOCK 16 /* Bytes per vector (one SSE2/NEON register) */
+
+int count_digits (const unsigned char *word, int length);
+
+#endif
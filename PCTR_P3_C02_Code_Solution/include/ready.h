@@ -0,0 +1,43 @@
+/*
+====================================================================
+Concurrent and Real-Time Programming
+Faculty of Computer Science
+University of Castilla-La Mancha (Spain)
+
+Contact info: http://www.libropctr.com
+
+You can redistribute and/or modify this file under the terms of the
+GNU General Public License ad published by the Free Software
+Foundation, either version 3 of the License, or (at your option) and
+later version. See <http://www.gnu.org/licenses/>.
+
+This file is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+====================================================================
+*/
+
+#ifndef __READY_H__
+#define __READY_H__
+
+/*
+  Readiness protocol between the manager and its children. Before forking,
+  the manager opens a pipe whose write end the children inherit (its
+  number travels in READY_FD_ENV). Every child writes one byte once its
+  IPC handles are open, and the manager waits for one byte per child,
+  failing after READY_TIMEOUT_MS or as soon as every child is gone.
+*/
+
+#define READY_FD_ENV      "PCTR_READY_FD"
+#define READY_TIMEOUT_MS  5000
+
+/* Manager side. open_ready_channel() returns the read end of the pipe,
+   or -1 (errno set) if it cannot be created */
+int open_ready_channel (void);
+int wait_ready         (int ready_fd, int n_children, int timeout_ms);
+
+/* Child side (does nothing when not started by a manager) */
+void notify_ready      (void);
+
+#endif
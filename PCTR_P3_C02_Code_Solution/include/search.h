@@ -0,0 +1,82 @@
+/*
+====================================================================
+Concurrent and Real-Time Programming
+Faculty of Computer Science
+University of Castilla-La Mancha (Spain)
+
+Contact info: http://www.libropctr.com
+
+You can redistribute and/or modify this file under the terms of the
+GNU General Public License ad published by the Free Software
+Foundation, either version 3 of the License, or (at your option) and
+later version. See <http://www.gnu.org/licenses/>.
+
+This file is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+====================================================================
+*/
+
+#ifndef __SEARCH_H__
+#define __SEARCH_H__
+
+/*
+  Word-boundary prefix search used by processors instead of strtok() and
+  strncmp() on every word. Blocks of SEARCH_BLOCK bytes are compared with
+  the first two bytes of the pattern using vector operations; only the
+  candidate positions are checked for a word start and the whole prefix.
+  Words are separated by WORD_SEPARATOR as in the tokenized version.
+
+  A list of patterns is compiled into a trie instead, walked once from
+  every word start: one pass over the line finds the words of all the
+  patterns, and a word may match several of them ("W" and "Wh").
+*/
+
+#define SEARCH_BLOCK 16 /* Bytes per vector (one SSE2/NEON register) */
+/* A word of length n matches at most n + 1 prefixes */
+#define MAX_MATCHES_PER_LINE (MAX_LINE_SIZE + MAX_WORDS_PER_LINE)
+
+/* Compiled pattern: its length is computed once per process */
+struct TPattern_t {
+  const char *text;
+  int length;
+};
+
+void compile_pattern (struct TPattern_t *pattern, const char *text);
+/* Offsets and lengths of the words of 'line' starting with the pattern */
+int find_prefix_words (const struct TPattern_t *pattern, const char *line, int length,
+		       int *starts, int *lengths);
+
+/* Trie node: children of a node are chained through 'sibling' */
+struct TTrieNode_t {
+  unsigned char byte;
+  int pattern; /* Pattern ending here, or -1 */
+  int child;   /* First child, or -1 */
+  int sibling; /* Next child of the same parent, or -1 */
+};
+
+/* Compiled pattern list. Node 0 is the root (the empty pattern) and its
+   children are also indexed by byte, as most words fail right there */
+struct TTrie_t {
+  int n_patterns;
+  char *texts[MAX_PATTERNS];
+  int first[256];
+  int n_nodes;
+  struct TTrieNode_t *nodes;
+};
+
+/* Word 'word' (index into starts/lengths) starts with pattern 'pattern' */
+struct TMatch_t {
+  int word;
+  int pattern;
+};
+
+/* "<p1>,<p2>,...": number of patterns, or -1 if too many or repeated */
+int compile_patterns (struct TTrie_t *trie, const char *list);
+void free_patterns (struct TTrie_t *trie);
+/* Words of 'line' starting with any pattern and every (word, pattern) pair */
+int find_trie_words (const struct TTrie_t *trie, const char *line, int length,
+		     int *starts, int *lengths, struct TMatch_t *matches, int *n_matches);
+
+#endif
@@ -0,0 +1,68 @@
+/*
+====================================================================
+Concurrent and Real-Time Programming
+Faculty of Computer Science
+University of Castilla-La Mancha (Spain)
+
+Contact info: http://www.libropctr.com
+
+You can redistribute and/or modify this file under the terms of the
+GNU General Public License ad published by the Free Software
+Foundation, either version 3 of the License, or (at your option) and
+later version. See <http://www.gnu.org/licenses/>.
+
+This file is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+====================================================================
+*/
+
+#ifndef __TRANSPORT_H__
+#define __TRANSPORT_H__
+
+#include <stddef.h>
+
+/*
+  Transport of MQ_LINES and MQ_RESULTS. Two backends share this
+  interface, selected at build time (make TRANSPORT=ring|mqueue):
+
+  - ring: bounded MPMC ring in a shared memory object. Slots are claimed
+    with atomic tickets and processes only enter the kernel (futex) to
+    sleep on an empty or full ring.
+  - mqueue: the POSIX message queues used so far.
+
+  The capacity is independent of the number of processes using the
+  channel. A channel that cannot be created or sized is reported on
+  stderr and NULL is returned.
+*/
+
+#ifndef CHANNEL_CAPACITY
+#define CHANNEL_CAPACITY 64 /* Messages buffered per channel */
+#endif
+
+struct TChannel_t; /* Defined by the backend */
+
+struct TChannel_t *create_channel (const char *name, long capacity, size_t msg_size);
+struct TChannel_t *open_channel   (const char *name);
+void close_channel                (struct TChannel_t *channel);
+void remove_channel               (const char *name);
+
+/* Messages waiting in the channel (a snapshot) */
+long channel_depth (struct TChannel_t *channel);
+
+/* Blocking calls. receive_message() returns the size of the message */
+void send_message    (struct TChannel_t *channel, const void *msg, size_t size);
+size_t receive_message (struct TChannel_t *channel, void *msg, size_t size);
+
+/* Non-blocking calls: FALSE when the channel is full (empty) */
+int try_send_message    (struct TChannel_t *channel, const void *msg, size_t size);
+int try_receive_message (struct TChannel_t *channel, void *msg, size_t size, size_t *length);
+
+/* Sleeps until 'readable' holds a message, 'writable' has room (either
+   may be NULL) or timeout_ms elapse. mqueue waits on both descriptors
+   with epoll; ring only waits on the futex of one channel ('readable'
+   when given) and relies on the timeout for the other */
+void wait_channels (struct TChannel_t *readable, struct TChannel_t *writable, int timeout_ms);
+
+#endif
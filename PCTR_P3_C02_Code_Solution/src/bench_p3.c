@@ -0,0 +1,386 @@
+/*
+====================================================================
+Concurrent and Real-Time Programming
+Faculty of Computer Science
+University of Castilla-La Mancha (Spain)
+
+Contact info: http://www.libropctr.com
+
+You can redistribute and/or modify this file under the terms of the
+GNU General Public License ad published by the Free Software
+Foundation, either version 3 of the License, or (at your option) and
+later version. See <http://www.gnu.org/licenses/>.
+
+This file is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+====================================================================
+*/
+
+/*
+  P3 digit counting benchmark. Every word of the input file is counted
+  with the former COUNTER loop (strlen() and isdigit() per byte), with the
+  vector kernel as processors do inline, and through a real COUNTER
+  process with one MQ_WORDS request per line. The pattern match of the
+  processors is measured too, with strtok() and strncmp() on every word
+  and with the vector prefix search (one pass per pattern of the list),
+  and with the trie of the whole list in a single pass. It uses the
+  regular queue names, so do not run it next to a manager.
+*/
+
+#define _DEFAULT_SOURCE
+
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <mqueue.h>
+#include <signal.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <definitions.h>
+#include <digits.h>
+#include <ready.h>
+#include <search.h>
+
+#define DEFAULT_FILE     "data/test_solution.txt"
+#define DEFAULT_PATTERN  "aux"
+#define DEFAULT_N_ROUNDS 2000
+#define MAX_BENCH_LINES  4096
+
+/* Every line of the file as a length-prefixed request */
+struct MsgWords_t g_lines[MAX_BENCH_LINES];
+int g_nLines, g_nWords;
+/* The same lines as read, for the pattern match */
+char g_text[MAX_BENCH_LINES][MAX_LINE_SIZE + 1];
+int g_textLength[MAX_BENCH_LINES];
+long g_nBytes;
+
+/* Input */
+void load_lines(const char *filename);
+
+/* Modes under test: all return the total number of digits */
+long scalar_mode(int n_rounds);
+long inline_mode(int n_rounds);
+long ipc_mode(int n_rounds);
+/* Pattern match: all return the number of (word, pattern) matches */
+long strtok_mode(int n_rounds, struct TTrie_t *trie);
+long search_mode(int n_rounds, struct TTrie_t *trie);
+long trie_mode(int n_rounds, struct TTrie_t *trie);
+
+/* Auxiliar functions */
+int scalar_count(const char *word);
+void print_mode(const char *mode, int n_rounds, double seconds);
+double now_seconds();
+
+/******************** Main function ********************/
+
+int main(int argc, char *argv[]) {
+  const char *filename, *pattern;
+  long scalar_sum, inline_sum, ipc_sum, strtok_sum, search_sum, trie_sum;
+  double t_scalar, t_inline, t_ipc, t_strtok, t_search, t_trie, start;
+  struct TTrie_t trie;
+  int n_rounds, n_ipc_rounds;
+
+  filename = (argc > 1) ? argv[1] : DEFAULT_FILE;
+  n_rounds = (argc > 2) ? atoi(argv[2]) : DEFAULT_N_ROUNDS;
+  pattern = (argc > 3) ? argv[3] : DEFAULT_PATTERN;
+  if (n_rounds < 1 || compile_patterns(&trie, pattern) == -1) {
+    fprintf(stderr, "Synopsis: ./exec/bench_p3 [file] [rounds] [pattern[,pattern...]].\n");
+    exit(EXIT_FAILURE);
+  }
+  load_lines(filename);
+
+  start = now_seconds();
+  scalar_sum = scalar_mode(n_rounds);
+  t_scalar = now_seconds() - start;
+
+  start = now_seconds();
+  inline_sum = inline_mode(n_rounds);
+  t_inline = now_seconds() - start;
+
+  /* A round trip costs far more than counting: fewer rounds */
+  n_ipc_rounds = (n_rounds + 9) / 10;
+  start = now_seconds();
+  ipc_sum = ipc_mode(n_ipc_rounds);
+  t_ipc = now_seconds() - start;
+
+  start = now_seconds();
+  strtok_sum = strtok_mode(n_rounds, &trie);
+  t_strtok = now_seconds() - start;
+
+  start = now_seconds();
+  search_sum = search_mode(n_rounds, &trie);
+  t_search = now_seconds() - start;
+
+  start = now_seconds();
+  trie_sum = trie_mode(n_rounds, &trie);
+  t_trie = now_seconds() - start;
+
+  if (inline_sum != scalar_sum || ipc_sum != scalar_sum / n_rounds * n_ipc_rounds) {
+    fprintf(stderr, "Modes disagree: %ld (scalar) %ld (inline) %ld (ipc)\n", scalar_sum, inline_sum, ipc_sum);
+    exit(EXIT_FAILURE);
+  }
+  if (search_sum != strtok_sum || trie_sum != strtok_sum) {
+    fprintf(stderr, "Pattern matches disagree: %ld (strtok) %ld (search) %ld (trie)\n", strtok_sum,
+	    search_sum, trie_sum);
+    exit(EXIT_FAILURE);
+  }
+
+  printf("mode,lines,words,ns_per_line,ns_per_word,gb_per_s\n");
+  print_mode("scalar", n_rounds, t_scalar);
+  print_mode("inline", n_rounds, t_inline);
+  print_mode("ipc", n_ipc_rounds, t_ipc);
+  print_mode("strtok", n_rounds, t_strtok);
+  print_mode("search", n_rounds, t_search);
+  print_mode("trie", n_rounds, t_trie);
+
+  free_patterns(&trie);
+
+  return EXIT_SUCCESS;
+}
+
+/******************** Input ********************/
+
+void load_lines(const char *filename) {
+  char line[MAX_LINE_SIZE], *word;
+  struct MsgWords_t *msg;
+  size_t length;
+  FILE *fp;
+
+  if ((fp = fopen(filename, "r")) == NULL) {
+    fprintf(stderr, "Error opening %s: %s.\n", filename, strerror(errno));
+    exit(EXIT_FAILURE);
+  }
+
+  /* Same tokenization as the processors, every word counted */
+  while (g_nLines < MAX_BENCH_LINES && fgets(line, sizeof(line), fp) != NULL) {
+    g_textLength[g_nLines] = strlen(line);
+    memcpy(g_text[g_nLines], line, g_textLength[g_nLines] + 1);
+    msg = &g_lines[g_nLines];
+    msg->reply_id = 0;
+    msg->n_words = msg->length = 0;
+    for (word = strtok(line, WORD_SEPARATOR); word != NULL; word = strtok(NULL, WORD_SEPARATOR)) {
+      length = strlen(word);
+      msg->words[msg->length++] = (unsigned char)length;
+      memcpy(&msg->words[msg->length], word, length);
+      msg->length += length;
+      msg->n_words++;
+    }
+    if (msg->n_words > 0) {
+      g_nWords += msg->n_words;
+      g_nBytes += g_textLength[g_nLines];
+      g_nLines++;
+    }
+  }
+  fclose(fp);
+
+  if (g_nLines == 0) {
+    fprintf(stderr, "No words in %s.\n", filename);
+    exit(EXIT_FAILURE);
+  }
+}
+
+/******************** Modes ********************/
+
+long scalar_mode(int n_rounds) {
+  char word[MAX_LINE_SIZE + 1];
+  long total = 0;
+  int r, i, j, offset, length;
+
+  for (r = 0; r < n_rounds; r++) {
+    for (i = 0; i < g_nLines; i++) {
+      for (j = 0, offset = 0; j < g_lines[i].n_words; j++) {
+	/* The former COUNTER received NUL-terminated words */
+	length = g_lines[i].words[offset];
+	memcpy(word, &g_lines[i].words[offset + 1], length);
+	word[length] = '\0';
+	total += scalar_count(word);
+	offset += length + 1;
+      }
+    }
+  }
+
+  return total;
+}
+
+long inline_mode(int n_rounds) {
+  char word[MAX_LINE_SIZE + 1];
+  long total = 0;
+  int r, i, j, offset, length;
+
+  for (r = 0; r < n_rounds; r++) {
+    for (i = 0; i < g_nLines; i++) {
+      for (j = 0, offset = 0; j < g_lines[i].n_words; j++) {
+	/* Processors hold NUL-terminated strtok() words */
+	length = g_lines[i].words[offset];
+	memcpy(word, &g_lines[i].words[offset + 1], length);
+	word[length] = '\0';
+	total += count_digits((const unsigned char *)word, strlen(word));
+	offset += length + 1;
+      }
+    }
+  }
+
+  return total;
+}
+
+long ipc_mode(int n_rounds) {
+  struct MsgDigits_t msg_digits;
+  struct mq_attr attr;
+  mqd_t q_handler_words, q_handler_reply;
+  char mq_name[MQ_NAME_SIZE];
+  long total = 0;
+  int r, i, j, ready_fd;
+  pid_t pid;
+
+  /* Same queues a manager creates for one processor */
+  sprintf(mq_name, "%s.%d", MQ_NUMBER_DIGITS, 0);
+  attr.mq_maxmsg = 1;
+  attr.mq_msgsize = sizeof(struct MsgWords_t);
+  q_handler_words = mq_open(MQ_WORDS, O_WRONLY | O_CREAT, S_IWUSR | S_IRUSR, &attr);
+  attr.mq_msgsize = sizeof(struct MsgDigits_t);
+  q_handler_reply = mq_open(mq_name, O_RDONLY | O_CREAT, S_IWUSR | S_IRUSR, &attr);
+  if (q_handler_words == (mqd_t)-1 || q_handler_reply == (mqd_t)-1) {
+    fprintf(stderr, "Error creating the message queues: %s.\n", strerror(errno));
+    mq_unlink(MQ_WORDS);
+    mq_unlink(mq_name);
+    exit(EXIT_FAILURE);
+  }
+
+  if ((ready_fd = open_ready_channel()) == -1) {
+    fprintf(stderr, "Error creating the readiness pipe: %s.\n", strerror(errno));
+    mq_unlink(MQ_WORDS);
+    mq_unlink(mq_name);
+    exit(EXIT_FAILURE);
+  }
+  switch (pid = fork()) {
+  case -1:
+    fprintf(stderr, "Error creating %s process: %s.\n", COUNTER_CLASS, strerror(errno));
+    exit(EXIT_FAILURE);
+  case 0:
+    execl(COUNTER_PATH, COUNTER_CLASS, "0", NULL);
+    fprintf(stderr, "Error using execl(): %s.\n", strerror(errno));
+    exit(EXIT_FAILURE);
+  }
+  if (!wait_ready(ready_fd, 1, READY_TIMEOUT_MS)) {
+    fprintf(stderr, "%s process not ready.\n", COUNTER_CLASS);
+    kill(pid, SIGINT);
+    exit(EXIT_FAILURE);
+  }
+
+  for (r = 0; r < n_rounds; r++) {
+    for (i = 0; i < g_nLines; i++) {
+      mq_send(q_handler_words, (const char *)&g_lines[i], MSG_WORDS_SIZE(&g_lines[i]), 0);
+      mq_receive(q_handler_reply, (char *)&msg_digits, sizeof(struct MsgDigits_t), NULL);
+      for (j = 0; j < msg_digits.n_words; j++) {
+	total += msg_digits.n_digits[j];
+      }
+    }
+  }
+
+  kill(pid, SIGINT);
+  waitpid(pid, NULL, 0);
+  mq_close(q_handler_words);
+  mq_close(q_handler_reply);
+  mq_unlink(MQ_WORDS);
+  mq_unlink(mq_name);
+
+  return total;
+}
+
+long strtok_mode(int n_rounds, struct TTrie_t *trie) {
+  char line[MAX_LINE_SIZE + 1], *word;
+  long total = 0;
+  int r, i, p;
+
+  for (r = 0; r < n_rounds; r++) {
+    for (i = 0; i < g_nLines; i++) {
+      /* Former process_line(): the line arrives in a message buffer */
+      memcpy(line, g_text[i], g_textLength[i] + 1);
+      for (word = strtok(line, WORD_SEPARATOR); word != NULL; word = strtok(NULL, WORD_SEPARATOR)) {
+	for (p = 0; p < trie->n_patterns; p++) {
+	  total += strncmp(word, trie->texts[p], strlen(trie->texts[p])) == 0;
+	}
+      }
+    }
+  }
+
+  return total;
+}
+
+long search_mode(int n_rounds, struct TTrie_t *trie) {
+  char line[MAX_LINE_SIZE + 1];
+  int starts[MAX_WORDS_PER_LINE], lengths[MAX_WORDS_PER_LINE];
+  struct TPattern_t compiled;
+  long total = 0;
+  int r, i, p;
+
+  /* One run per pattern, as before pattern lists */
+  for (p = 0; p < trie->n_patterns; p++) {
+    compile_pattern(&compiled, trie->texts[p]);
+    for (r = 0; r < n_rounds; r++) {
+      for (i = 0; i < g_nLines; i++) {
+	memcpy(line, g_text[i], g_textLength[i] + 1);
+	total += find_prefix_words(&compiled, line, g_textLength[i], starts, lengths);
+      }
+    }
+  }
+
+  return total;
+}
+
+long trie_mode(int n_rounds, struct TTrie_t *trie) {
+  char line[MAX_LINE_SIZE + 1];
+  int starts[MAX_WORDS_PER_LINE], lengths[MAX_WORDS_PER_LINE];
+  struct TMatch_t matches[MAX_MATCHES_PER_LINE];
+  long total = 0;
+  int r, i, n_matches;
+
+  for (r = 0; r < n_rounds; r++) {
+    for (i = 0; i < g_nLines; i++) {
+      memcpy(line, g_text[i], g_textLength[i] + 1);
+      find_trie_words(trie, line, g_textLength[i], starts, lengths, matches, &n_matches);
+      total += n_matches;
+    }
+  }
+
+  return total;
+}
+
+/******************** Auxiliar functions ********************/
+
+int scalar_count(const char *word) {
+  int i, n_digits = 0;
+
+  /* Former count_number() loop */
+  for (i = 0; i < strlen(word); i++) {
+    if (isdigit(word[i]) != 0) {
+      n_digits++;
+    }
+  }
+
+  return n_digits;
+}
+
+void print_mode(const char *mode, int n_rounds, double seconds) {
+  /* Throughput over the bytes of the lines, separators included */
+  printf("%s,%ld,%ld,%.1f,%.1f,%.3f\n", mode, (long)n_rounds * g_nLines, (long)n_rounds * g_nWords,
+	 seconds * 1e9 / ((double)n_rounds * g_nLines), seconds * 1e9 / ((double)n_rounds * g_nWords),
+	 (double)n_rounds * g_nBytes / seconds / 1e9);
+}
+
+double now_seconds() {
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
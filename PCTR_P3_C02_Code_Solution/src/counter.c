@@ -21,34 +21,38 @@ General Public License for more details.
 #include <errno.h>
 #include <fcntl.h>
 #include <mqueue.h>
+#include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
-#include <ctype.h>
-
 
 #include <definitions.h>
+#include <digits.h>
+#include <ready.h>
 
 /* Message queue management */
 void open_message_queue(const char *mq_name, mode_t mode, mqd_t *q_handler);
 /* Task management */
-void count_number(mqd_t q_handler_words, mqd_t q_handler_number_digits);
+void count_number(mqd_t q_handler_words, mqd_t *q_handlers_number_digits);
 
 int main (int argc, char * argv[]){
 
-  mqd_t q_handler_words, q_handler_number_digits;
+  mqd_t q_handler_words, q_handlers_number_digits[MAX_PROCESSORS];
   mode_t mode_read_only = O_RDONLY;
-  mode_t mode_write_only = O_WRONLY;
+  int i;
 
-    /* Open message queues */
+    /* Open message queues (reply queues on first use) */
   
   open_message_queue(MQ_WORDS, mode_read_only, &q_handler_words);
-  open_message_queue(MQ_NUMBER_DIGITS, mode_write_only, &q_handler_number_digits);
+  for (i = 0; i < MAX_PROCESSORS; i++) {
+    q_handlers_number_digits[i] = (mqd_t)-1;
+  }
+  notify_ready();
   while(TRUE){
-    count_number(q_handler_words, q_handler_number_digits);
+    count_number(q_handler_words, q_handlers_number_digits);
   }
   return EXIT_SUCCESS;
 }
@@ -57,19 +61,35 @@ void open_message_queue(const char *mq_name, mode_t mode, mqd_t *q_handler){
     *q_handler = mq_open(mq_name, mode);
 }
 
-void count_number(mqd_t q_handler_words, mqd_t q_handler_number_digits){
+void count_number(mqd_t q_handler_words, mqd_t *q_handlers_number_digits){
     
-    char word[MAX_LINE_SIZE];
-    int i, n_digits;
-    n_digits = 0;
+    struct MsgWords_t msg_words;
+    struct MsgDigits_t msg_digits;
+    char mq_name[MQ_NAME_SIZE];
+    unsigned char *word;
+    int j, length, offset = 0;
+
+    mq_receive(q_handler_words,(char*)&msg_words,sizeof(struct MsgWords_t),NULL);
 
-    mq_receive(q_handler_words,word,sizeof(word),NULL);
+    /* One count per length-prefixed word */
+    msg_digits.n_words = 0;
+    for (j = 0; j < msg_words.n_words && j < MAX_WORDS_PER_LINE && offset < msg_words.length; j++) {
+      length = msg_words.words[offset];
+      word = &msg_words.words[offset + 1];
+      offset += length + 1;
 
-    for (i=0;i<strlen(word);i++){
-      if((isdigit(word[i]) != 0)){
-        n_digits++;
-      }
+      msg_digits.n_digits[j] = count_digits(word, length);
+      msg_digits.n_words++;
     }
 
-    mq_send(q_handler_number_digits,(char*)&n_digits,sizeof(int),0);
+    /* Reply routing: the queue of the requesting processor */
+    if (msg_words.reply_id < 0 || msg_words.reply_id >= MAX_PROCESSORS) {
+      fprintf(stderr, "[COUNTER %d] Invalid reply queue %d.\n", getpid(), msg_words.reply_id);
+      return;
+    }
+    if (q_handlers_number_digits[msg_words.reply_id] == (mqd_t)-1) {
+      sprintf(mq_name, "%s.%d", MQ_NUMBER_DIGITS, msg_words.reply_id);
+      open_message_queue(mq_name, O_WRONLY, &q_handlers_number_digits[msg_words.reply_id]);
+    }
+    mq_send(q_handlers_number_digits[msg_words.reply_id],(char*)&msg_digits,MSG_DIGITS_SIZE(&msg_digits),0);
 }
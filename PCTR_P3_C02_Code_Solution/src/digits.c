@@ -0,0 +1,48 @@
+/*
+====================================================================
+Concurrent and Real-Time Programming
+Faculty of Computer Science
+University of Castilla-La Mancha (Spain)
+
+Contact info: http://www.libropctr.com
+
+You can redistribute and/or modify this file under the terms of the
+GNU General Public License ad published by the Free Software
+Foundation, either version 3 of the License, or (at your option) and
+later version. See <http://www.gnu.org/licenses/>.
+
+This file is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+====================================================================
+*/
+
+#include <string.h>
+
+#include <digits.h>
+
+typedef unsigned char vbytes_t __attribute__((vector_size(DIGITS_BLOCK)));
+
+int count_digits(const unsigned char *word, int length) {
+  unsigned long long lanes[DIGITS_BLOCK / sizeof(unsigned long long)];
+  vbytes_t block, hits;
+  int i, j, n_digits = 0;
+
+  for (i = 0; i + DIGITS_BLOCK <= length; i += DIGITS_BLOCK) {
+    /* Unaligned load; '0'..'9' are the only bytes below 10 after the shift */
+    memcpy(&block, word + i, DIGITS_BLOCK);
+    hits = (vbytes_t)((block - '0') < 10) & 1;
+
+    memcpy(lanes, &hits, DIGITS_BLOCK);
+    for (j = 0; j < DIGITS_BLOCK / sizeof(unsigned long long); j++) {
+      n_digits += __builtin_popcountll(lanes[j]);
+    }
+  }
+
+  for (; i < length; i++) {
+    n_digits += (unsigned char)(word[i] - '0') < 10;
+  }
+
+  return n_digits;
+}
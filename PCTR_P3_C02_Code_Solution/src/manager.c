@@ -24,85 +24,144 @@ General Public License for more details.
 #include <errno.h>
 #include <mqueue.h>
 #include <signal.h>
+#include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/mman.h>
 #include <sys/stat.h>
+#include <sys/wait.h>
+#include <time.h>
 #include <unistd.h>
 
 #include <definitions.h>
+#include <ready.h>
+#include <search.h>
+#include <transport.h>
 
 /* Total number of processes */
 int g_nProcesses;
 /* 'Process table' (child processes) */
 struct TProcess_t *g_process_table;
+/* Processors (each one owns a reply queue) */
+int g_nProcessors;
+/* No COUNTER processes: processors count digits inline */
+int g_inline;
+/* Pattern list, passed once to every processor (compiled here only to
+   validate it and to name the per-pattern totals) */
+char *g_pattern;
+struct TTrie_t g_trie;
+/* Bytes repeated at the start of a chunk continuing a word: enough for
+   the longest pattern to decide the match */
+int g_headSize;
+/* Elastic pool: processors own table slots [0, g_maxProcessors) */
+int g_minProcessors, g_maxProcessors;
+int g_nActive;           /* Running processors not yet sent a poison pill */
+int g_nRetiring;         /* Poison pills whose processor has not been reaped */
+int g_nIdleSamples;      /* Empty MQ_LINES samples in a row */
+int g_nScaleUps, g_nScaleDowns, g_peakProcessors;
+long g_lastSampleMs;
+/* Reorder buffer: results by task id (bounded by the in-flight window) */
+struct MsgResult_t g_reorder[CHANNEL_CAPACITY];
+int g_nextTask;          /* Next task id to be emitted */
+int g_nBuffered;         /* Results waiting for an earlier one */
+int g_reorderHighWater;
+struct TLineRecord_t g_currentLine;
+/* Per-line records: stdout (text) or a file (text or binary) */
+FILE *g_records;
+int g_binary;
 
 /* Process management */
 void create_processes_by_class(enum ProcessClass_t class, int n_processes, int index_process_table);
-pid_t create_single_process(const char *class, const char *path, const char *argv);
+pid_t create_single_process(const char *path, char *const args[]);
 void get_str_process_info(enum ProcessClass_t class, char **path, char **str_process_class);
 void init_process_table(int n_processors, int n_counters);
 void terminate_processes();
 
+/* Elastic pool */
+void autoscale(struct TChannel_t *q_handler_lines, int blocked);
+int get_free_slot();
+void reap_processors();
+void retire_processor(struct TChannel_t *q_handler_lines);
+
+/* Ordered output */
+void init_reorder_buffer();
+void reorder_result(struct MsgResult_t *partial_results);
+void emit_line(struct TLineRecord_t *record);
+void flush_lines();
+
 /* Message queue management */
+void create_channels(struct TChannel_t **q_handler_lines, struct TChannel_t **q_handler_results);
 void create_message_queue(const char *mq_name, mode_t mode, long mq_maxmsg, long mq_msgsize, mqd_t *q_handler);
-void close_message_queues(mqd_t q_handler_lines, mqd_t q_handler_results,  mqd_t q_handler_words, mqd_t q_handler_number_digits, mqd_t q_handler_mutex);
+void create_reply_queues(int n_processors);
+void close_message_queues(struct TChannel_t *q_handler_lines, struct TChannel_t *q_handler_results, mqd_t q_handler_words);
 
 /* Task management */
-void send_lines(const char *filename, char *pattern, int *n_lines, mqd_t q_handler_lines);
-void receive_partial_results(int n_lines, struct MsgResult_t *global_results, mqd_t q_handler_results);
+void manage_tasks(const char *filename, struct TChannel_t *q_handler_lines,
+		  struct TChannel_t *q_handler_results, struct MsgResult_t *global_results);
+size_t get_chunk_size(const char *line, size_t length, size_t capacity);
+void print_progress(int n_received, int n_sent, struct MsgResult_t *global_results, int last);
 
 /* Auxiliar functions */
 void free_resources();
 void install_signal_handler();
-void parse_argv(int argc, char *argv[], int *n_processors, char **p_pattern, char **p_filename);
+long now_ms();
+void parse_argv(int argc, char *argv[], int *n_processors, char **p_pattern, char **p_filename, int *n_counters);
 void print_result(struct MsgResult_t *global_results);
+void print_scaling();
 void signal_handler(int signo);
 
 /******************** Main function ********************/
 
 int main(int argc, char *argv[]) {
-  mqd_t q_handler_lines, q_handler_results;
-  mqd_t q_handler_words, q_handler_number_digits, q_handler_mutex;
+  struct TChannel_t *q_handler_lines, *q_handler_results;
+  mqd_t q_handler_words;
   mode_t mode_creat_only = O_CREAT;
-  mode_t mode_creat_read_only = (O_RDONLY | O_CREAT);
-  mode_t mode_creat_write_only = (O_WRONLY | O_CREAT);
   struct MsgResult_t global_results;
   global_results.n_words = global_results.n_digits = 0;
   
-  char *pattern, *filename, token;
-  int n_processors, n_lines = 0;
+  char *pattern, *filename;
+  int n_processors, n_counters;
 
   /* Install signal handler and parse arguments*/
   install_signal_handler();
-  parse_argv(argc, argv, &n_processors, &pattern, &filename);
-
-  /* Init the process table*/
-  init_process_table(n_processors, NUM_COUNTERS);
-
-  /* Create message queues */
-  create_message_queue(MQ_LINES, mode_creat_write_only, n_processors, sizeof(struct MsgLine_t), &q_handler_lines);
-  create_message_queue(MQ_RESULTS, mode_creat_read_only, n_processors,sizeof(struct MsgResult_t), &q_handler_results);
-  create_message_queue(MQ_WORDS, mode_creat_only, 1, MAX_LINE_SIZE * sizeof(char), &q_handler_words);
-  create_message_queue(MQ_NUMBER_DIGITS, mode_creat_only, 1,sizeof(int), &q_handler_number_digits);
-  create_message_queue(MQ_MUTEX, mode_creat_write_only, 1,sizeof(char), &q_handler_mutex);  
-  /* Init the mutex mailbox */
-  mq_send(q_handler_mutex, &token, sizeof(char), 0);
+  parse_argv(argc, argv, &n_processors, &pattern, &filename, &n_counters);
+  g_pattern = pattern;
+  global_results.n_patterns = g_trie.n_patterns;
+  memset(global_results.counts, 0, sizeof(global_results.counts));
+  init_reorder_buffer();
+
+  /* Init the process table (room for the largest pool) */
+  n_processors = g_maxProcessors;
+  init_process_table(n_processors, n_counters);
+
+  /* Create message queues. Every processor has at most one request pending,
+     so no global mutex is needed around the COUNTER round trip */
+  create_channels(&q_handler_lines, &q_handler_results);
+  q_handler_words = (mqd_t)-1;
+  if (!g_inline) {
+    create_message_queue(MQ_WORDS, mode_creat_only, n_processors, sizeof(struct MsgWords_t), &q_handler_words);
+    create_reply_queues(n_processors);
+  }
 
-  /* Create processes */
-  create_processes_by_class(PROCESSOR, n_processors, 0);
-  create_processes_by_class(COUNTER, NUM_COUNTERS, n_processors);
+  /* Create processes (the smallest pool) */
+  create_processes_by_class(PROCESSOR, g_minProcessors, 0);
+  g_nActive = g_peakProcessors = g_minProcessors;
+  g_lastSampleMs = now_ms();
+  if (!g_inline) {
+    create_processes_by_class(COUNTER, n_counters, n_processors);
+  }
 
   /* Manage tasks */
-  send_lines(filename, pattern, &n_lines, q_handler_lines);
-  receive_partial_results(n_lines, &global_results, q_handler_results);
+  manage_tasks(filename, q_handler_lines, q_handler_results, &global_results);
 
   /* Print the decoded text */
   print_result(&global_results);
+  print_scaling();
+  printf("\tReorder buffer: high-water mark of %d results (capacity %d)\n", g_reorderHighWater, CHANNEL_CAPACITY);
 
   /* Free resources and terminate */
-  close_message_queues(q_handler_lines, q_handler_results, q_handler_words, q_handler_number_digits, q_handler_mutex);
+  close_message_queues(q_handler_lines, q_handler_results, q_handler_words);
   terminate_processes();
   free_resources();
 
@@ -112,14 +171,31 @@ int main(int argc, char *argv[]) {
 /******************** Process Management ********************/
 
 void create_processes_by_class(enum ProcessClass_t class, int n_processes, int index_process_table) {
-  char *path = NULL, *str_process_class = NULL;
-  int i;
+  char *path = NULL, *str_process_class = NULL, *args[5], id_str[16];
+  int i, ready_fd;
   pid_t pid;
 
   get_str_process_info(class, &path, &str_process_class);
 
+  /* <class> <id> [<pattern> [--inline]] */
+  args[0] = str_process_class;
+  args[1] = id_str;
+  args[2] = args[3] = args[4] = NULL;
+  if (class == PROCESSOR) {
+    args[2] = g_pattern;
+    args[3] = g_inline ? INLINE_FLAG : NULL;
+  }
+
+  if ((ready_fd = open_ready_channel()) == -1) {
+    fprintf(stderr, "[MANAGER] Error creating the readiness pipe: %s.\n", strerror(errno));
+    terminate_processes();
+    free_resources();
+    exit(EXIT_FAILURE);
+  }
   for (i = index_process_table; i < (index_process_table + n_processes); i++) {
-    pid = create_single_process(path, str_process_class, NULL);
+    /* Id within the class (a processor's id, its slot, selects its reply queue) */
+    sprintf(id_str, "%d", (class == PROCESSOR) ? i : i - index_process_table);
+    pid = create_single_process(path, args);
 
     g_process_table[i].class = class;
     g_process_table[i].pid = pid;
@@ -127,10 +203,16 @@ void create_processes_by_class(enum ProcessClass_t class, int n_processes, int i
   }
 
   printf("[MANAGER] %d %s processes created.\n", n_processes, str_process_class);
-  sleep(1);
+  if (!wait_ready(ready_fd, n_processes, READY_TIMEOUT_MS)) {
+    fprintf(stderr, "[MANAGER] Not every %s process reported ready.\n", str_process_class);
+    terminate_processes();
+    free_resources();
+    exit(EXIT_FAILURE);
+  }
 }
 
-pid_t create_single_process(const char *path, const char *class, const char *argv) {
+pid_t create_single_process(const char *path, char *const args[]) {
+  const char *class = args[0];
   pid_t pid;
 
   switch (pid = fork()) {
@@ -142,8 +224,8 @@ pid_t create_single_process(const char *path, const char *class, const char *arg
     exit(EXIT_FAILURE);
     /* Child process */
   case 0 : 
-    if (execl(path, class, argv, NULL) == -1) {
-      fprintf(stderr, "[MANAGER] Error using execl() in %s process: %s.\n", 
+    if (execv(path, args) == -1) {
+      fprintf(stderr, "[MANAGER] Error using execv() in %s process: %s.\n", 
 	      class, strerror(errno));
       exit(EXIT_FAILURE);
     }
@@ -197,31 +279,209 @@ void terminate_processes() {
   }
 }
 
+/******************** Elastic pool ********************/
+
+void autoscale(struct TChannel_t *q_handler_lines, int blocked) {
+  long depth, elapsed;
+  int slot, idle;
+
+  if (g_minProcessors == g_maxProcessors || (elapsed = now_ms() - g_lastSampleMs) < SCALE_INTERVAL_MS) {
+    return;
+  }
+  g_lastSampleMs = now_ms();
+
+  /* Idle: nothing queued and nothing held back. A long wait for input
+     counts as one sample per period elapsed; a wait on a full window or
+     queue never does */
+  reap_processors();
+  depth = channel_depth(q_handler_lines);
+  idle = (depth == 0 && !blocked);
+  g_nIdleSamples = idle ? g_nIdleSamples + elapsed / SCALE_INTERVAL_MS : 0;
+
+  /* Backlog: more than one queued line per processor, or chunks held back
+     by a full window or queue (the window caps the depth) */
+  if ((depth > g_nActive || blocked) && g_nActive < g_maxProcessors && (slot = get_free_slot()) != -1) {
+    create_processes_by_class(PROCESSOR, 1, slot);
+    g_nActive++;
+    g_nScaleUps++;
+    if (g_nActive > g_peakProcessors) {
+      g_peakProcessors = g_nActive;
+    }
+    printf("[MANAGER] Scaling up to %d processors (%ld lines queued%s).\n", g_nActive, depth,
+	   blocked ? ", more held back" : "");
+  }
+  /* Idle: retire one processor without losing any line */
+  else if (g_nIdleSamples >= SCALE_IDLE_SAMPLES && g_nActive > g_minProcessors) {
+    retire_processor(q_handler_lines);
+    g_nIdleSamples = 0;
+    printf("[MANAGER] Scaling down to %d processors (no lines queued).\n", g_nActive);
+  }
+}
+
+int get_free_slot() {
+  int i;
+
+  for (i = 0; i < g_maxProcessors; i++) {
+    if (g_process_table[i].pid == 0) {
+      return i;
+    }
+  }
+
+  return -1;
+}
+
+void reap_processors() {
+  int i;
+
+  for (i = 0; i < g_maxProcessors; i++) {
+    if (g_process_table[i].pid != 0 && waitpid(g_process_table[i].pid, NULL, WNOHANG) == g_process_table[i].pid) {
+      g_process_table[i].pid = 0;
+      /* Not retired by us: it crashed */
+      if (g_nRetiring > 0) {
+	g_nRetiring--;
+      }
+      else {
+	g_nActive--;
+      }
+    }
+  }
+}
+
+void retire_processor(struct TChannel_t *q_handler_lines) {
+  struct MsgLine_t msg_line;
+
+  /* Queued behind every pending line: whoever takes it has no line in flight */
+  msg_line.length = POISON_PILL;
+  send_message(q_handler_lines, &msg_line, offsetof(struct MsgLine_t, line));
+  g_nActive--;
+  g_nRetiring++;
+  g_nScaleDowns++;
+}
+
+/******************** Ordered output ********************/
+
+void init_reorder_buffer() {
+  int i;
+
+  for (i = 0; i < CHANNEL_CAPACITY; i++) {
+    g_reorder[i].task_id = -1;
+  }
+  g_currentLine.line_number = 0;
+}
+
+void reorder_result(struct MsgResult_t *partial_results) {
+  struct MsgResult_t *next, *slot;
+
+  /* Tasks are only sent within CHANNEL_CAPACITY of the next one to be
+     emitted (see manage_tasks()), so a slot is free when its result comes */
+  slot = &g_reorder[partial_results->task_id % CHANNEL_CAPACITY];
+  if (slot->task_id != -1) {
+    fprintf(stderr, "[MANAGER] Reorder buffer slot of task %d still holds task %d.\n",
+	    partial_results->task_id, slot->task_id);
+    terminate_processes();
+    free_resources();
+    exit(EXIT_FAILURE);
+  }
+  *slot = *partial_results;
+  g_nBuffered++;
+
+  /* Emit the run that starts at the next task id */
+  while ((next = &g_reorder[g_nextTask % CHANNEL_CAPACITY])->task_id == g_nextTask) {
+    /* Chunks of a line are consecutive tasks: one record per line */
+    if (next->line_number != g_currentLine.line_number) {
+      flush_lines();
+      g_currentLine.line_number = next->line_number;
+    }
+    g_currentLine.n_words += next->n_words;
+    g_currentLine.n_digits += next->n_digits;
+
+    next->task_id = -1;
+    g_nextTask++;
+    g_nBuffered--;
+  }
+
+  if (g_nBuffered > g_reorderHighWater) {
+    g_reorderHighWater = g_nBuffered;
+  }
+}
+
+void emit_line(struct TLineRecord_t *record) {
+  if (g_records == NULL) {
+    printf("[MANAGER] Line %d: %d words -- %d digits\n", record->line_number, record->n_words, record->n_digits);
+  }
+  else if (g_binary) {
+    fwrite(record, sizeof(struct TLineRecord_t), 1, g_records);
+  }
+  else {
+    fprintf(g_records, "%d\t%d\t%d\n", record->line_number, record->n_words, record->n_digits);
+  }
+}
+
+void flush_lines() {
+  if (g_currentLine.line_number > 0) {
+    emit_line(&g_currentLine);
+  }
+  g_currentLine.line_number = g_currentLine.n_words = g_currentLine.n_digits = 0;
+}
+
 /******************** Message queue management ********************/
 
+void create_channels(struct TChannel_t **q_handler_lines, struct TChannel_t **q_handler_results) {
+  /* Capacity is not tied to the number of processors */
+  if ((*q_handler_lines = create_channel(MQ_LINES, CHANNEL_CAPACITY, sizeof(struct MsgLine_t))) == NULL ||
+      (*q_handler_results = create_channel(MQ_RESULTS, CHANNEL_CAPACITY, sizeof(struct MsgResult_t))) == NULL) {
+    fprintf(stderr, "[MANAGER] Error creating the channels.\n");
+    free_resources();
+    exit(EXIT_FAILURE);
+  }
+}
+
 void create_message_queue(const char *mq_name, mode_t mode, long mq_maxmsg, long mq_msgsize, mqd_t *q_handler) {
   struct mq_attr attr;
 
   attr.mq_maxmsg = mq_maxmsg;
   attr.mq_msgsize = mq_msgsize;
-  *q_handler = mq_open(mq_name, mode, S_IWUSR | S_IRUSR, &attr);
-  
+  if ((*q_handler = mq_open(mq_name, mode, S_IWUSR | S_IRUSR, &attr)) == (mqd_t)-1) {
+    fprintf(stderr, "[MANAGER] Error creating message queue %s (%ld messages of %ld bytes): %s.\n",
+	    mq_name, mq_maxmsg, mq_msgsize, strerror(errno));
+    free_resources();
+    exit(EXIT_FAILURE);
+  }
+}
+
+void create_reply_queues(int n_processors) {
+  char mq_name[MQ_NAME_SIZE];
+  mqd_t q_handler;
+  int i;
+
+  g_nProcessors = n_processors;
+  for (i = 0; i < n_processors; i++) {
+    sprintf(mq_name, "%s.%d", MQ_NUMBER_DIGITS, i);
+    create_message_queue(mq_name, O_CREAT, 1, sizeof(struct MsgDigits_t), &q_handler);
+    mq_close(q_handler);
+  }
 }
 
-void close_message_queues(mqd_t q_handler_lines, mqd_t q_handler_results,  mqd_t q_handler_words,mqd_t q_handler_number_digits, mqd_t q_handler_mutex) {
-  mq_close(q_handler_lines);
-  mq_close(q_handler_results);
-  mq_close(q_handler_words);
-  mq_close(q_handler_number_digits);
-  mq_close(q_handler_mutex);
+void close_message_queues(struct TChannel_t *q_handler_lines, struct TChannel_t *q_handler_results, mqd_t q_handler_words) {
+  close_channel(q_handler_lines);
+  close_channel(q_handler_results);
+  if (q_handler_words != (mqd_t)-1) {
+    mq_close(q_handler_words);
+  }
 }
 
 /******************** Task management ********************/
 
-void send_lines(const char *filename, char *pattern, int *n_lines, mqd_t q_handler_lines) {
+void manage_tasks(const char *filename, struct TChannel_t *q_handler_lines,
+		  struct TChannel_t *q_handler_results, struct MsgResult_t *global_results) {
   FILE *fp;
-  char line[MAX_LINE_SIZE];
+  char *line = NULL;
+  const char *next = NULL, *word = NULL;
+  size_t line_size = 0, remaining = 0, length, chunk;
+  ssize_t line_length;
   struct MsgLine_t msg_line;
+  struct MsgResult_t partial_results;
+  int i, n_sent = 0, n_received = 0, n_lines = 0, eof = FALSE, ready = FALSE, blocked = FALSE, progress, can_send;
 
   /* Open the file */
   if ((fp = fopen(filename, "r")) == NULL) {
@@ -231,46 +491,147 @@ void send_lines(const char *filename, char *pattern, int *n_lines, mqd_t q_handl
     exit(EXIT_FAILURE);
   }
 
-  /* Read one line at a time and send tasks */
-  while (fgets(line, sizeof(line), fp) != NULL) {
-    strcpy(msg_line.line, line);
-    strcpy(msg_line.pattern, pattern);
-    mq_send(q_handler_lines, (const char *)&msg_line, sizeof(struct MsgLine_t), 0);
-    ++*n_lines;
+  /* Event loop: sends and collects at the same time, and only sleeps when
+     neither a result is waiting nor the next chunk can go out */
+  while (!eof || ready || n_received < n_sent) {
+    progress = FALSE;
+
+    /* Collect every result already there */
+    while (n_received < n_sent &&
+	   try_receive_message(q_handler_results, &partial_results, sizeof(struct MsgResult_t), &length)) {
+      global_results->n_words += partial_results.n_words;
+      global_results->n_digits += partial_results.n_digits;
+      for (i = 0; i < partial_results.n_patterns; i++) {
+	global_results->counts[i].n_words += partial_results.counts[i].n_words;
+	global_results->counts[i].n_digits += partial_results.counts[i].n_digits;
+      }
+      reorder_result(&partial_results);
+      n_received++;
+      progress = TRUE;
+    }
+
+    /* Next chunk, reading a new line (of any length) when needed */
+    if (!ready && remaining == 0 && !eof) {
+      if ((line_length = getline(&line, &line_size, fp)) == -1) {
+	eof = TRUE;
+      }
+      else {
+	next = line;
+	remaining = line_length;
+	n_lines++;
+      }
+    }
+    if (!ready && remaining > 0) {
+      msg_line.task_id = n_sent;
+      msg_line.line_number = n_lines;
+      /* A word cut by the previous chunk: its start goes first again */
+      msg_line.head = (word != NULL) ? g_headSize : 0;
+      memcpy(msg_line.line, word, msg_line.head);
+      chunk = get_chunk_size(next, remaining, MAX_LINE_SIZE - msg_line.head);
+      memcpy(&msg_line.line[msg_line.head], next, chunk);
+      msg_line.length = msg_line.head + chunk;
+
+      /* Cut inside a word: the chunk holds no separator at all, so the
+	 word starts right here unless it was already continued */
+      if (chunk < remaining && next[chunk - 1] != WORD_SEPARATOR[0] && next[chunk] != WORD_SEPARATOR[0]) {
+	word = (word != NULL) ? word : next;
+      }
+      else {
+	word = NULL;
+      }
+      next += chunk;
+      remaining -= chunk;
+      ready = TRUE;
+    }
+
+    /* No more tasks in flight than results fit in MQ_RESULTS (or in the
+       reorder buffer): the window starts at the oldest result not yet
+       emitted, so a slow task holds back later sends instead of having
+       its reorder slot overwritten */
+    can_send = ready && (n_sent - g_nextTask) < CHANNEL_CAPACITY;
+
+    /* On its own timer, whether sending or waiting, before this send */
+    autoscale(q_handler_lines, blocked);
+
+    if (can_send && try_send_message(q_handler_lines, &msg_line, MSG_LINE_SIZE(&msg_line))) {
+      n_sent++;
+      ready = FALSE;
+      progress = TRUE;
+    }
+    /* A chunk waits on a full window or queue */
+    blocked = ready;
+
+    print_progress(n_received, n_sent, global_results, FALSE);
+    if (!progress && (n_received < n_sent || can_send)) {
+      wait_channels((n_received < n_sent) ? q_handler_results : NULL, can_send ? q_handler_lines : NULL,
+		    SCALE_INTERVAL_MS);
+    }
+  }
+  print_progress(n_received, n_sent, global_results, TRUE);
+  flush_lines();
+  if (g_records != NULL) {
+    fclose(g_records);
   }
 
+  free(line);
   fclose(fp);
 }
 
-void receive_partial_results(int n_lines, struct MsgResult_t *global_results, mqd_t q_handler_results) {
-  int i;
-  int n_words = 0;
-  int n_digits = 0;
+size_t get_chunk_size(const char *line, size_t length, size_t capacity) {
+  size_t chunk;
+
+  if (length <= capacity) {
+    return length;
+  }
 
-  for(i=0;i<n_lines;i++){
-    mq_receive(q_handler_results,(char*)global_results,sizeof(struct MsgResult_t),NULL);
-    n_words += global_results->n_words;
-    n_digits += global_results->n_digits;
+  /* Cut at a word boundary whenever there is one: the tail of a cut word
+     needs a head (see MsgLine_t). A single word fills the whole chunk */
+  if (line[capacity] == WORD_SEPARATOR[0]) {
+    return capacity;
   }
-  global_results->n_words = n_words;
-  global_results->n_digits = n_digits;
+  for (chunk = capacity; chunk > 0 && line[chunk - 1] != WORD_SEPARATOR[0]; chunk--);
 
+  return (chunk > 0) ? chunk : capacity;
+}
+
+void print_progress(int n_received, int n_sent, struct MsgResult_t *global_results, int last) {
+  static long last_ms;
+  static int last_received = -1;
+
+  /* Running totals, at most once per PROGRESS_INTERVAL_MS. Tasks are
+     counted: a chunk is a whole line unless the line is a long one */
+  if (last_ms == 0) {
+    last_ms = now_ms();
+  }
+  if ((!last && now_ms() - last_ms < PROGRESS_INTERVAL_MS) || n_received == last_received) {
+    return;
+  }
+  last_ms = now_ms();
+  last_received = n_received;
+  printf("[MANAGER] %d/%d chunks processed: %d words -- %d digits so far\n", n_received, n_sent,
+	 global_results->n_words, global_results->n_digits);
 }
 
 /******************** Auxiliar functions ********************/
 
 void free_resources() {
+  char mq_name[MQ_NAME_SIZE];
+  int i;
+
   printf("\n----- [MANAGER] Freeing resources ----- \n");
 
   /* Free the 'process table' memory */
   free(g_process_table); 
+  free_patterns(&g_trie);
 
   /* Remove message queues */
-  mq_unlink(MQ_LINES);
-  mq_unlink(MQ_RESULTS);
+  remove_channel(MQ_LINES);
+  remove_channel(MQ_RESULTS);
   mq_unlink(MQ_WORDS);
-  mq_unlink(MQ_NUMBER_DIGITS);
-  mq_unlink(MQ_MUTEX);
+  for (i = 0; i < g_nProcessors; i++) {
+    sprintf(mq_name, "%s.%d", MQ_NUMBER_DIGITS, i);
+    mq_unlink(mq_name);
+  }
 }
 
 void install_signal_handler() {
@@ -280,20 +641,98 @@ void install_signal_handler() {
   }
 }
 
-void parse_argv(int argc, char *argv[], int *n_processors, char **p_pattern, char **p_filename) {
-  if (argc != 4) {
-    fprintf(stderr, "Synopsis: ./exec/manager <n_processors> <pattern> <file>.\n");
+long now_ms() {
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000L + ts.tv_nsec / 1000000L;
+}
+
+void parse_argv(int argc, char *argv[], int *n_processors, char **p_pattern, char **p_filename, int *n_counters) {
+  char *args[4], *records_path = NULL;
+  int i, n_args = 0;
+
+  /* Options may go anywhere, the rest are positional arguments */
+  for (i = 1; i < argc; i++) {
+    if (strcmp(argv[i], RECORDS_FLAG) == 0 && i + 1 < argc) {
+      records_path = argv[++i];
+    }
+    else if (strcmp(argv[i], BINARY_FLAG) == 0) {
+      g_binary = TRUE;
+    }
+    else if (n_args < 4) {
+      args[n_args++] = argv[i];
+    }
+    else {
+      n_args = 0;
+      break;
+    }
+  }
+
+  if (n_args < 3 || (g_binary && records_path == NULL)) {
+    fprintf(stderr, "Synopsis: ./exec/manager [%s <path> [%s]] <n_processors | min-max> <pattern[,pattern...]> <file> "
+	    "[n_counters (0: inline)].\n", RECORDS_FLAG, BINARY_FLAG);
     exit(EXIT_FAILURE); 
   }
   
-  *n_processors = atoi(argv[1]);  
-  *p_pattern = argv[2];
-  *p_filename = argv[3];
+  if (records_path != NULL && (g_records = fopen(records_path, g_binary ? "wb" : "w")) == NULL) {
+    fprintf(stderr, "[MANAGER] Error opening %s: %s.\n", records_path, strerror(errno));
+    exit(EXIT_FAILURE);
+  }
+
+  /* "n" (fixed pool) or "min-max" (elastic pool) */
+  if (sscanf(args[0], "%d-%d", &g_minProcessors, &g_maxProcessors) != 2) {
+    g_minProcessors = g_maxProcessors = atoi(args[0]);
+  }
+  *n_processors = g_minProcessors;
+  *p_pattern = args[1];
+  *p_filename = args[2];
+  *n_counters = (n_args == 4) ? atoi(args[3]) : DEFAULT_COUNTERS;
+
+  if (compile_patterns(&g_trie, *p_pattern) == -1) {
+    fprintf(stderr, "[MANAGER] At most %d patterns (separated by '%s') and none repeated.\n",
+	    MAX_PATTERNS, PATTERN_SEPARATOR);
+    exit(EXIT_FAILURE);
+  }
+  /* At least one byte, so that the empty pattern also sees a head */
+  for (i = 0, g_headSize = 1; i < g_trie.n_patterns; i++) {
+    if (strlen(g_trie.texts[i]) > MAX_PATTERN_SIZE) {
+      fprintf(stderr, "[MANAGER] Patterns may not be longer than %d bytes.\n", MAX_PATTERN_SIZE);
+      exit(EXIT_FAILURE);
+    }
+    if (strlen(g_trie.texts[i]) > g_headSize) {
+      g_headSize = strlen(g_trie.texts[i]);
+    }
+  }
+
+  if (g_minProcessors < 1 || g_maxProcessors < g_minProcessors || g_maxProcessors > MAX_PROCESSORS || *n_counters < 0) {
+    fprintf(stderr, "[MANAGER] Between 1 and %d processors and no negative counters.\n", MAX_PROCESSORS);
+    exit(EXIT_FAILURE);
+  }
+  g_inline = (*n_counters == 0);
 }
 
 void print_result(struct MsgResult_t *global_results) {
+  int i;
+
   printf("\n----- [MANAGER] Printing result ----- \n");
   printf("\t%d words -- %d digits\n", global_results->n_words, global_results->n_digits);
+
+  /* A word matching several patterns counts once above, once for each here */
+  if (global_results->n_patterns > 1) {
+    for (i = 0; i < global_results->n_patterns; i++) {
+      printf("\t'%s': %d words -- %d digits\n", g_trie.texts[i], global_results->counts[i].n_words,
+	     global_results->counts[i].n_digits);
+    }
+  }
+}
+
+void print_scaling() {
+  if (g_minProcessors == g_maxProcessors) {
+    return;
+  }
+  printf("\t%d-%d processors: %d scale-ups, %d scale-downs, peak of %d\n", g_minProcessors,
+	 g_maxProcessors, g_nScaleUps, g_nScaleDowns, g_peakProcessors);
 }
 
 void signal_handler(int signo) {
@@ -21,6 +21,7 @@ General Public License for more details.
 #include <errno.h>
 #include <fcntl.h>
 #include <mqueue.h>
+#include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -29,38 +30,75 @@ General Public License for more details.
 #include <unistd.h>
 
 #include <definitions.h>
+#include <digits.h>
+#include <ready.h>
+#include <search.h>
+#include <transport.h>
+
+/* Digits counted in this process instead of by a COUNTER */
+int g_inline = FALSE;
+/* Patterns of the whole run, from the command line (the single
+   pattern search is kept for lists of one) */
+struct TTrie_t g_trie;
+struct TPattern_t g_pattern;
 
 /* Message queue management */
 void open_message_queue(const char *mq_name, mode_t mode, mqd_t *q_handler);
+struct TChannel_t *open_channel_or_exit(const char *name);
 
 /* Task management */
-void process_line(struct MsgResult_t *partial_results, mqd_t q_handler_lines, 
-		  mqd_t q_handler_mutex, mqd_t q_handler_words, mqd_t q_handler_number_digits);
-void send_partial_results(struct MsgResult_t *partial_results, mqd_t q_handler_results);
+int process_line(int id, struct MsgResult_t *partial_results, struct TChannel_t *q_handler_lines, 
+		 mqd_t q_handler_words, mqd_t q_handler_number_digits);
+void send_partial_results(struct MsgResult_t *partial_results, struct TChannel_t *q_handler_results);
 
 /******************** Main function ********************/
 
 int main(int argc, char *argv[]) {
-  mqd_t q_handler_lines, q_handler_results;
-  mqd_t q_handler_words, q_handler_number_digits, q_handler_mutex;
+  struct TChannel_t *q_handler_lines, *q_handler_results;
+  mqd_t q_handler_words, q_handler_number_digits;
   mode_t mode_read_only = O_RDONLY;
   mode_t mode_write_only = O_WRONLY;
-  mode_t mode_read_write = O_RDWR;
   struct MsgResult_t partial_results;
+  char mq_name[MQ_NAME_SIZE];
+  int id;
+
+  /* The manager passes the processor id (it selects the reply queue) and the pattern */
+  if (argc < 3 || argc > 4 || (argc == 4 && strcmp(argv[3], INLINE_FLAG) != 0)) {
+    fprintf(stderr, "[PROCESSOR %d] Error in the command line.\n", getpid());
+    exit(EXIT_FAILURE);
+  }
+  id = atoi(argv[1]);
+  if (compile_patterns(&g_trie, argv[2]) == -1) {
+    fprintf(stderr, "[PROCESSOR %d] Invalid pattern list.\n", getpid());
+    exit(EXIT_FAILURE);
+  }
+  compile_pattern(&g_pattern, g_trie.texts[0]);
+  g_inline = (argc == 4);
+  sprintf(mq_name, "%s.%d", MQ_NUMBER_DIGITS, id);
   
   /* Open message queues */
-  open_message_queue(MQ_LINES, mode_read_only, &q_handler_lines);
-  open_message_queue(MQ_RESULTS, mode_write_only, &q_handler_results);
-  open_message_queue(MQ_WORDS, mode_write_only, &q_handler_words);
-  open_message_queue(MQ_NUMBER_DIGITS, mode_read_only, &q_handler_number_digits);
-  open_message_queue(MQ_MUTEX, mode_read_write, &q_handler_mutex);
+  q_handler_lines = open_channel_or_exit(MQ_LINES);
+  q_handler_results = open_channel_or_exit(MQ_RESULTS);
+  if (!g_inline) {
+    open_message_queue(MQ_WORDS, mode_write_only, &q_handler_words);
+    open_message_queue(mq_name, mode_read_only, &q_handler_number_digits);
+  }
+  notify_ready();
 
   /* Task management */
-  while (TRUE) {
-    process_line(&partial_results, q_handler_lines, q_handler_mutex, q_handler_words, q_handler_number_digits);
+  /* Until the manager retires us with a poison pill */
+  while (process_line(id, &partial_results, q_handler_lines, q_handler_words, q_handler_number_digits)) {
     send_partial_results(&partial_results, q_handler_results);
   }
 
+  close_channel(q_handler_lines);
+  close_channel(q_handler_results);
+  if (!g_inline) {
+    mq_close(q_handler_words);
+    mq_close(q_handler_number_digits);
+  }
+  free_patterns(&g_trie);
+
   return EXIT_SUCCESS;
 }
 
@@ -70,57 +108,111 @@ void open_message_queue(const char *mq_name, mode_t mode, mqd_t *q_handler) {
   *q_handler = mq_open(mq_name, mode);
 }
 
+struct TChannel_t *open_channel_or_exit(const char *name) {
+  struct TChannel_t *channel;
+
+  /* The manager would never get ready: fail fast */
+  if ((channel = open_channel(name)) == NULL) {
+    exit(EXIT_FAILURE);
+  }
+
+  return channel;
+}
+
 /******************** Task management ********************/
 
-void process_line(struct MsgResult_t *partial_results, mqd_t q_handler_lines, mqd_t q_handler_mutex, mqd_t q_handler_words, mqd_t q_handler_number_digits) {
+int process_line(int id, struct MsgResult_t *partial_results, struct TChannel_t *q_handler_lines, mqd_t q_handler_words, mqd_t q_handler_number_digits) {
   
-  char *word, *pattern, word_copy[MAX_LINE_SIZE], token;
-  int n_words = 0, n_digits = 0;
+  int starts[MAX_WORDS_PER_LINE], lengths[MAX_WORDS_PER_LINE];
+  struct TMatch_t matches[MAX_MATCHES_PER_LINE];
+  struct TPatternCount_t *count;
+  int i, n_words, n_matches, continued;
   struct MsgLine_t msg_line;
+  struct MsgWords_t msg_words;
+  struct MsgDigits_t msg_digits;
 
-  /* Initialize number of digits */
+  /* Initialize the counters */
   partial_results->n_digits = 0;
+  partial_results->n_patterns = g_trie.n_patterns;
+  memset(partial_results->counts, 0, g_trie.n_patterns * sizeof(struct TPatternCount_t));
 
   /* Wait for a new task*/
-  mq_receive(q_handler_lines, (char *)&msg_line, sizeof(struct MsgLine_t), NULL);
-  pattern = msg_line.pattern;
+  receive_message(q_handler_lines, &msg_line, sizeof(struct MsgLine_t));
+  if (msg_line.length == POISON_PILL) {
+    printf("[PROCESSOR %d] Retired by the manager.\n", getpid());
+    return FALSE;
+  }
+  partial_results->task_id = msg_line.task_id;
+  partial_results->line_number = msg_line.line_number;
   
-  /* Word processing */
-  word = strtok(msg_line.line, WORD_SEPARATOR);
-
-  while (word != NULL) {
-    
-    /* Start with 'pattern'? */
-    if (strncmp(word, pattern, strlen(pattern)) == 0) {
-      n_words++;
-
-      /* Extra copy to avoid inconsistencies*/ 
-      strcpy(word_copy, word);
-
-      /* Mutex to guarantee the exclusive use of the COUNTER */
-      mq_receive(q_handler_mutex, &token, sizeof(char), NULL);
-        /* Rendezvous with the counter process */
-      mq_send(q_handler_words, word_copy, sizeof(word_copy), 0);
-	    mq_receive(q_handler_number_digits, (char *)&n_digits, sizeof(int), NULL);
-      
-      mq_send(q_handler_mutex, &token, sizeof(char), 0);
-
-      /* Update the number of digits for the processed line */
-      partial_results->n_digits += n_digits;
-
-      printf("[PROCESSOR %d]: '%s' found in '%s' with %d digits\n", getpid(), pattern, word, n_digits);
+  /* Word processing: only the words starting with a pattern are
+     delimited, the rest of the line is never tokenized */
+  if (g_trie.n_patterns == 1) {
+    n_words = n_matches = find_prefix_words(&g_pattern, msg_line.line, msg_line.length, starts, lengths);
+    for (i = 0; i < n_words; i++) {
+      matches[i].word = i;
+      matches[i].pattern = 0;
     }
+  }
+  else {
+    n_words = find_trie_words(&g_trie, msg_line.line, msg_line.length, starts, lengths, matches, &n_matches);
+  }
 
-    word = strtok(NULL, WORD_SEPARATOR);
+  /* A matching word continued from an earlier chunk (see MsgLine_t): it
+     was counted there, only the digits past its head are left */
+  if ((continued = (msg_line.head > 0 && n_words > 0 && starts[0] == 0))) {
+    starts[0] += msg_line.head;
+    lengths[0] -= msg_line.head;
+  }
+
+  if (n_words > 0) {
+    if (g_inline) {
+      for (i = 0; i < n_words; i++) {
+	msg_digits.n_digits[i] = count_digits((const unsigned char *)&msg_line.line[starts[i]], lengths[i]);
+      }
+    }
+    else {
+      /* The matching words of the line go in one request (once each,
+	 whatever the number of patterns they match) */
+      msg_words.reply_id = id;
+      msg_words.n_words = n_words;
+      msg_words.length = 0;
+      for (i = 0; i < n_words; i++) {
+	msg_words.words[msg_words.length++] = (unsigned char)lengths[i];
+	memcpy(&msg_words.words[msg_words.length], &msg_line.line[starts[i]], lengths[i]);
+	msg_words.length += lengths[i];
+      }
+
+      /* Rendezvous with any COUNTER: the reply comes to our own queue */
+      mq_send(q_handler_words, (const char *)&msg_words, MSG_WORDS_SIZE(&msg_words), 0);
+      mq_receive(q_handler_number_digits, (char *)&msg_digits, sizeof(struct MsgDigits_t), NULL);
+    }
+
+    /* Update the number of digits for the processed line */
+    for (i = 0; i < n_words; i++) {
+      partial_results->n_digits += msg_digits.n_digits[i];
+    }
+    for (i = 0; i < n_matches; i++) {
+      count = &partial_results->counts[matches[i].pattern];
+      count->n_digits += msg_digits.n_digits[matches[i].word];
+      if (continued && matches[i].word == 0) {
+	continue;
+      }
+      count->n_words++;
+      printf("[PROCESSOR %d]: '%s' found in '%.*s' with %d digits\n", getpid(), g_trie.texts[matches[i].pattern],
+	     lengths[matches[i].word], &msg_line.line[starts[matches[i].word]], msg_digits.n_digits[matches[i].word]);
+    }
   }
 
   /* Dont remove (simulates complexity) */
   sleep(1);
 
   /* Update the number of words */
-  partial_results->n_words = n_words;
+  partial_results->n_words = n_words - continued;
+
+  return TRUE;
 }
 
-void send_partial_results(struct MsgResult_t *partial_results, mqd_t q_handler_results) {
-  mq_send(q_handler_results, (const char *)partial_results, sizeof(struct MsgResult_t), 0);
+void send_partial_results(struct MsgResult_t *partial_results, struct TChannel_t *q_handler_results) {
+  send_message(q_handler_results, partial_results, MSG_RESULT_SIZE(partial_results));
 }
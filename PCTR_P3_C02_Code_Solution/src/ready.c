@@ -0,0 +1,118 @@
+/*
+====================================================================
+Concurrent and Real-Time Programming
+Faculty of Computer Science
+University of Castilla-La Mancha (Spain)
+
+Contact info: http://www.libropctr.com
+
+You can redistribute and/or modify this file under the terms of the
+GNU General Public License ad published by the Free Software
+Foundation, either version 3 of the License, or (at your option) and
+later version. See <http://www.gnu.org/licenses/>.
+
+This file is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+====================================================================
+*/
+
+#define _DEFAULT_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <ready.h>
+
+/* Write end kept by the manager until every child has been forked */
+static int g_ready_write_fd = -1;
+
+/* Auxiliar functions */
+long elapsed_ms(const struct timespec *start);
+
+int open_ready_channel(void) {
+  char fd_str[16];
+  int fds[2];
+
+  if (pipe(fds) == -1) {
+    return -1;
+  }
+
+  /* The read end stays in the manager; the write end crosses execl() */
+  fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+  sprintf(fd_str, "%d", fds[1]);
+  setenv(READY_FD_ENV, fd_str, 1);
+  g_ready_write_fd = fds[1];
+
+  return fds[0];
+}
+
+int wait_ready(int ready_fd, int n_children, int timeout_ms) {
+  struct pollfd pfd;
+  struct timespec start;
+  char buffer[64];
+  long remaining;
+  ssize_t n;
+  int n_ready = 0;
+
+  /* Only the children may hold the write end now (EOF = all of them gone) */
+  close(g_ready_write_fd);
+  g_ready_write_fd = -1;
+  unsetenv(READY_FD_ENV);
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  pfd.fd = ready_fd;
+  pfd.events = POLLIN;
+
+  while (n_ready < n_children) {
+    if ((remaining = timeout_ms - elapsed_ms(&start)) <= 0) {
+      break;
+    }
+    if ((n = poll(&pfd, 1, (int)remaining)) == -1 && errno == EINTR) {
+      continue;
+    }
+    /* Error or timeout */
+    if (n <= 0) {
+      break;
+    }
+    if ((n = read(ready_fd, buffer, sizeof(buffer))) == -1 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      break;
+    }
+    n_ready += n;
+  }
+  close(ready_fd);
+
+  return n_ready >= n_children;
+}
+
+void notify_ready(void) {
+  char *fd_str;
+  int fd;
+
+  if ((fd_str = getenv(READY_FD_ENV)) == NULL) {
+    return;
+  }
+  fd = atoi(fd_str);
+  if (write(fd, "", 1) == -1) {
+    fprintf(stderr, "[%d] Error notifying readiness.\n", getpid());
+  }
+  close(fd);
+}
+
+/******************** Auxiliar functions ********************/
+
+long elapsed_ms(const struct timespec *start) {
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (now.tv_sec - start->tv_sec) * 1000 + (now.tv_nsec - start->tv_nsec) / 1000000;
+}
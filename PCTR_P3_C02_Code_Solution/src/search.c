@@ -0,0 +1,234 @@
+/*
+====================================================================
+Concurrent and Real-Time Programming
+Faculty of Computer Science
+University of Castilla-La Mancha (Spain)
+
+Contact info: http://www.libropctr.com
+
+You can redistribute and/or modify this file under the terms of the
+GNU General Public License ad published by the Free Software
+Foundation, either version 3 of the License, or (at your option) and
+later version. See <http://www.gnu.org/licenses/>.
+
+This file is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+====================================================================
+*/
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <definitions.h>
+#include <search.h>
+
+typedef unsigned char vbytes_t __attribute__((vector_size(SEARCH_BLOCK)));
+
+int next_candidate(const struct TPattern_t *pattern, const char *line, int length, int from);
+int match_word(const char *line, int length, int start, int *starts, int *lengths, int n_words);
+int add_pattern(struct TTrie_t *trie, const char *text, int pattern);
+int find_child(const struct TTrie_t *trie, int node, unsigned char byte);
+
+/******************** Single pattern ********************/
+
+void compile_pattern(struct TPattern_t *pattern, const char *text) {
+  pattern->text = text;
+  pattern->length = strlen(text);
+}
+
+int find_prefix_words(const struct TPattern_t *pattern, const char *line, int length,
+		      int *starts, int *lengths) {
+  int i, n_words = 0;
+
+  /* An empty prefix matches every word: no byte to filter on */
+  if (pattern->length == 0) {
+    for (i = 0; i < length; i++) {
+      if (line[i] != WORD_SEPARATOR[0] && (i == 0 || line[i - 1] == WORD_SEPARATOR[0])) {
+	n_words = match_word(line, length, i, starts, lengths, n_words);
+      }
+    }
+    return n_words;
+  }
+
+  for (i = next_candidate(pattern, line, length, 0); i < length;
+       i = next_candidate(pattern, line, length, i + 1)) {
+    /* Only at the start of a word, as strtok() would have split it */
+    if ((i == 0 || line[i - 1] == WORD_SEPARATOR[0]) && i + pattern->length <= length &&
+	memcmp(&line[i], pattern->text, pattern->length) == 0) {
+      n_words = match_word(line, length, i, starts, lengths, n_words);
+    }
+  }
+
+  return n_words;
+}
+
+/* First position at or after 'from' holding the first two bytes of the pattern */
+int next_candidate(const struct TPattern_t *pattern, const char *line, int length, int from) {
+  unsigned long long lanes[SEARCH_BLOCK / sizeof(unsigned long long)];
+  vbytes_t block, next, hits;
+  unsigned char first = pattern->text[0];
+  unsigned char second = (pattern->length > 1) ? pattern->text[1] : 0;
+  int i, j;
+
+  /* Two-byte filter: the byte after each lane must be the second one too */
+  for (i = from; i + SEARCH_BLOCK < length; i += SEARCH_BLOCK) {
+    memcpy(&block, line + i, SEARCH_BLOCK);
+    memcpy(&next, line + i + 1, SEARCH_BLOCK);
+    hits = (vbytes_t)(block == first);
+    if (pattern->length > 1) {
+      hits &= (vbytes_t)(next == second);
+    }
+
+    memcpy(lanes, &hits, SEARCH_BLOCK);
+    for (j = 0; j < SEARCH_BLOCK / sizeof(unsigned long long); j++) {
+      if (lanes[j] != 0) {
+	/* Little-endian lanes: the lowest set byte is the first hit */
+	return i + j * sizeof(unsigned long long) + __builtin_ctzll(lanes[j]) / 8;
+      }
+    }
+  }
+
+  /* Tail of the line: memchr() on the first byte */
+  if (i < length) {
+    const char *hit = memchr(line + i, first, length - i);
+    return (hit != NULL) ? hit - line : length;
+  }
+
+  return length;
+}
+
+/* Records the word starting at 'start', up to the next separator */
+int match_word(const char *line, int length, int start, int *starts, int *lengths, int n_words) {
+  const char *end = memchr(line + start, WORD_SEPARATOR[0], length - start);
+
+  starts[n_words] = start;
+  lengths[n_words] = (end != NULL) ? end - line - start : length - start;
+
+  return n_words + 1;
+}
+
+/******************** Pattern lists ********************/
+
+int compile_patterns(struct TTrie_t *trie, const char *list) {
+  char *text, *separator;
+  int i;
+
+  memset(trie, 0, sizeof(struct TTrie_t));
+  for (i = 0; i < 256; i++) {
+    trie->first[i] = -1;
+  }
+
+  /* One node per pattern byte at most, plus the root, and a private copy
+     of the list cut at every separator */
+  if ((trie->nodes = malloc((strlen(list) + 1) * sizeof(struct TTrieNode_t))) == NULL ||
+      (trie->texts[0] = malloc(strlen(list) + 1)) == NULL) {
+    fprintf(stderr, "[%d] Error allocating the pattern trie: %s.\n", getpid(), strerror(errno));
+    exit(EXIT_FAILURE);
+  }
+  trie->nodes[0].pattern = trie->nodes[0].child = trie->nodes[0].sibling = -1;
+  trie->n_nodes = 1;
+
+  strcpy(trie->texts[0], list);
+  for (text = trie->texts[0]; text != NULL; text = separator) {
+    if ((separator = strchr(text, PATTERN_SEPARATOR[0])) != NULL) {
+      *separator++ = '\0';
+    }
+    if (trie->n_patterns == MAX_PATTERNS || !add_pattern(trie, text, trie->n_patterns)) {
+      free_patterns(trie);
+      return -1;
+    }
+    trie->texts[trie->n_patterns++] = text;
+  }
+
+  return trie->n_patterns;
+}
+
+void free_patterns(struct TTrie_t *trie) {
+  free(trie->texts[0]);
+  free(trie->nodes);
+  trie->nodes = NULL;
+  trie->n_patterns = 0;
+}
+
+int find_trie_words(const struct TTrie_t *trie, const char *line, int length,
+		    int *starts, int *lengths, struct TMatch_t *matches, int *n_matches) {
+  const struct TTrieNode_t *nodes = trie->nodes;
+  const char *end;
+  int i, j, k, node, n_words = 0, n_before;
+
+  *n_matches = 0;
+  for (i = 0; i < length; i = j + 1) {
+    /* Next word: [i, j) */
+    if (line[i] == WORD_SEPARATOR[0]) {
+      j = i;
+      continue;
+    }
+    end = memchr(line + i, WORD_SEPARATOR[0], length - i);
+    j = (end != NULL) ? end - line : length;
+
+    /* Every pattern on the path from the root is a prefix of the word */
+    n_before = *n_matches;
+    if (nodes[0].pattern != -1) {
+      matches[(*n_matches)++] = (struct TMatch_t){n_words, nodes[0].pattern};
+    }
+    for (k = i, node = trie->first[(unsigned char)line[i]]; node != -1; ) {
+      if (nodes[node].pattern != -1) {
+	matches[(*n_matches)++] = (struct TMatch_t){n_words, nodes[node].pattern};
+      }
+      node = (++k < j) ? find_child(trie, node, line[k]) : -1;
+    }
+
+    if (*n_matches > n_before) {
+      starts[n_words] = i;
+      lengths[n_words++] = j - i;
+    }
+  }
+
+  return n_words;
+}
+
+int add_pattern(struct TTrie_t *trie, const char *text, int pattern) {
+  struct TTrieNode_t *new_node;
+  int node = 0, child;
+
+  for (; *text != '\0'; text++, node = child) {
+    if ((child = find_child(trie, node, *text)) == -1) {
+      child = trie->n_nodes++;
+      new_node = &trie->nodes[child];
+      new_node->byte = *text;
+      new_node->pattern = new_node->child = -1;
+      /* Prepend to the children of the node */
+      new_node->sibling = trie->nodes[node].child;
+      trie->nodes[node].child = child;
+      if (node == 0) {
+	trie->first[(unsigned char)*text] = child;
+      }
+    }
+  }
+
+  /* Repeated pattern */
+  if (trie->nodes[node].pattern != -1) {
+    return FALSE;
+  }
+  trie->nodes[node].pattern = pattern;
+
+  return TRUE;
+}
+
+int find_child(const struct TTrie_t *trie, int node, unsigned char byte) {
+  int child;
+
+  if (node == 0) {
+    return trie->first[byte];
+  }
+  for (child = trie->nodes[node].child; child != -1 && trie->nodes[child].byte != byte;
+       child = trie->nodes[child].sibling);
+
+  return child;
+}
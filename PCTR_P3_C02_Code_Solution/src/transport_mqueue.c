@@ -0,0 +1,191 @@
+/*
+====================================================================
+Concurrent and Real-Time Programming
+Faculty of Computer Science
+University of Castilla-La Mancha (Spain)
+
+Contact info: http://www.libropctr.com
+
+You can redistribute and/or modify this file under the terms of the
+GNU General Public License ad published by the Free Software
+Foundation, either version 3 of the License, or (at your option) and
+later version. See <http://www.gnu.org/licenses/>.
+
+This file is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+====================================================================
+*/
+
+/*
+  mqueue backend of transport.h (make TRANSPORT=mqueue): one POSIX
+  message queue per channel.
+*/
+
+#define _DEFAULT_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <mqueue.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#include <definitions.h>
+#include <transport.h>
+
+#define MSG_MAX_PATH     "/proc/sys/fs/mqueue/msg_max"
+#define MSGSIZE_MAX_PATH "/proc/sys/fs/mqueue/msgsize_max"
+
+struct TChannel_t {
+  mqd_t q_handler;
+};
+
+/* Descriptors of wait_channels() */
+static int g_epoll_fd = -1;
+
+/* Auxiliar functions */
+long read_limit(const char *path);
+void watch_channel(struct TChannel_t *channel, int op, unsigned int events);
+
+struct TChannel_t *create_channel(const char *name, long capacity, size_t msg_size) {
+  struct TChannel_t *channel;
+  struct mq_attr attr;
+  mqd_t q_handler;
+
+  attr.mq_maxmsg = capacity;
+  attr.mq_msgsize = msg_size;
+  if ((q_handler = mq_open(name, O_RDWR | O_CREAT, S_IWUSR | S_IRUSR, &attr)) == (mqd_t)-1) {
+    fprintf(stderr, "Error creating message queue %s: %s.\n", name, strerror(errno));
+    if (errno == EINVAL) {
+      fprintf(stderr, "  %ld messages of %zu bytes requested, limits are %ld (%s) and %ld (%s).\n",
+	      capacity, msg_size, read_limit(MSG_MAX_PATH), MSG_MAX_PATH,
+	      read_limit(MSGSIZE_MAX_PATH), MSGSIZE_MAX_PATH);
+    }
+    return NULL;
+  }
+
+  if ((channel = malloc(sizeof(struct TChannel_t))) == NULL) {
+    mq_close(q_handler);
+    return NULL;
+  }
+  channel->q_handler = q_handler;
+
+  return channel;
+}
+
+struct TChannel_t *open_channel(const char *name) {
+  struct TChannel_t *channel;
+  mqd_t q_handler;
+
+  if ((q_handler = mq_open(name, O_RDWR)) == (mqd_t)-1) {
+    fprintf(stderr, "Error opening message queue %s: %s.\n", name, strerror(errno));
+    return NULL;
+  }
+
+  if ((channel = malloc(sizeof(struct TChannel_t))) == NULL) {
+    mq_close(q_handler);
+    return NULL;
+  }
+  channel->q_handler = q_handler;
+
+  return channel;
+}
+
+void close_channel(struct TChannel_t *channel) {
+  mq_close(channel->q_handler);
+  free(channel);
+}
+
+void remove_channel(const char *name) {
+  mq_unlink(name);
+}
+
+long channel_depth(struct TChannel_t *channel) {
+  struct mq_attr attr;
+
+  if (mq_getattr(channel->q_handler, &attr) == -1) {
+    return 0;
+  }
+
+  return attr.mq_curmsgs;
+}
+
+void send_message(struct TChannel_t *channel, const void *msg, size_t size) {
+  mq_send(channel->q_handler, (const char *)msg, size, 0);
+}
+
+size_t receive_message(struct TChannel_t *channel, void *msg, size_t size) {
+  ssize_t length;
+
+  /* 'size' must hold the largest message of the queue */
+  length = mq_receive(channel->q_handler, (char *)msg, size, NULL);
+
+  return (length < 0) ? 0 : length;
+}
+
+int try_send_message(struct TChannel_t *channel, const void *msg, size_t size) {
+  struct timespec expired = {0, 0};
+
+  /* An absolute timeout in the past never blocks */
+  return mq_timedsend(channel->q_handler, (const char *)msg, size, 0, &expired) == 0;
+}
+
+int try_receive_message(struct TChannel_t *channel, void *msg, size_t size, size_t *length) {
+  struct timespec expired = {0, 0};
+  ssize_t received;
+
+  if ((received = mq_timedreceive(channel->q_handler, (char *)msg, size, NULL, &expired)) < 0) {
+    return FALSE;
+  }
+  *length = received;
+
+  return TRUE;
+}
+
+void wait_channels(struct TChannel_t *readable, struct TChannel_t *writable, int timeout_ms) {
+  struct epoll_event events[2];
+
+  /* On Linux an mqd_t is a descriptor epoll can watch */
+  if (g_epoll_fd == -1 && (g_epoll_fd = epoll_create1(EPOLL_CLOEXEC)) == -1) {
+    fprintf(stderr, "Error creating the epoll instance: %s.\n", strerror(errno));
+    exit(EXIT_FAILURE);
+  }
+
+  watch_channel(readable, EPOLL_CTL_ADD, EPOLLIN);
+  watch_channel(writable, EPOLL_CTL_ADD, EPOLLOUT);
+  epoll_wait(g_epoll_fd, events, 2, timeout_ms);
+  watch_channel(readable, EPOLL_CTL_DEL, 0);
+  watch_channel(writable, EPOLL_CTL_DEL, 0);
+}
+
+/******************** Auxiliar functions ********************/
+
+void watch_channel(struct TChannel_t *channel, int op, unsigned int events) {
+  struct epoll_event event;
+
+  if (channel == NULL) {
+    return;
+  }
+  event.events = events;
+  event.data.ptr = channel;
+  epoll_ctl(g_epoll_fd, op, channel->q_handler, &event);
+}
+
+long read_limit(const char *path) {
+  FILE *fp;
+  long limit = -1;
+
+  if ((fp = fopen(path, "r")) != NULL) {
+    if (fscanf(fp, "%ld", &limit) != 1) {
+      limit = -1;
+    }
+    fclose(fp);
+  }
+
+  return limit;
+}
@@ -0,0 +1,396 @@
+/*
+====================================================================
+Concurrent and Real-Time Programming
+Faculty of Computer Science
+University of Castilla-La Mancha (Spain)
+
+Contact info: http://www.libropctr.com
+
+You can redistribute and/or modify this file under the terms of the
+GNU General Public License ad published by the Free Software
+Foundation, either version 3 of the License, or (at your option) and
+later version. See <http://www.gnu.org/licenses/>.
+
+This file is distributed in the hope that it will be useful, but
+WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+General Public License for more details.
+====================================================================
+*/
+
+/*
+  ring backend of transport.h (default, make TRANSPORT=ring).
+
+  Bounded MPMC queue with one sequence number per slot: a producer owns
+  slot (ticket % capacity) once its sequence equals the ticket, and a
+  consumer once it equals ticket + 1. 'puts' and 'takes' count completed
+  operations and double as futex words, so only processes finding the
+  ring empty (or full) sleep, and only then does the other side wake
+  them up.
+*/
+
+#define _DEFAULT_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <linux/futex.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <definitions.h>
+#include <transport.h>
+
+#define RING_SHM_PREFIX "/ring."
+#define CACHE_LINE      64
+#define MAX_RING_BYTES  (64L << 20)
+
+struct TRing_t {
+  unsigned int capacity;  /* Power of two */
+  unsigned int slot_size; /* TRingSlot_t plus the message, cache-aligned */
+  size_t msg_size;
+  size_t size;            /* Bytes mapped */
+  unsigned int head __attribute__((aligned(CACHE_LINE))); /* Next put ticket */
+  unsigned int tail __attribute__((aligned(CACHE_LINE))); /* Next take ticket */
+  int puts __attribute__((aligned(CACHE_LINE)));          /* Futex word of consumers */
+  int consumers_waiting;
+  int takes __attribute__((aligned(CACHE_LINE)));         /* Futex word of producers */
+  int producers_waiting;
+};
+
+struct TRingSlot_t {
+  unsigned int sequence;
+  unsigned int length;
+  char msg[];
+};
+
+struct TChannel_t {
+  struct TRing_t *ring;
+};
+
+/* Ring operations */
+int try_put(struct TRing_t *ring, const void *msg, size_t size);
+int try_take(struct TRing_t *ring, void *msg, size_t size, size_t *length);
+void notify_put(struct TRing_t *ring);
+void notify_take(struct TRing_t *ring);
+struct TRingSlot_t *get_slot(struct TRing_t *ring, unsigned int ticket);
+
+/* Auxiliar functions */
+struct TChannel_t *map_channel(const char *name, int fd, size_t size);
+void get_shm_name(const char *name, char *shm_name);
+int futex_wait(int *uaddr, int val);
+int futex_wait_timeout(int *uaddr, int val, int timeout_ms);
+int futex_wake(int *uaddr, int n);
+
+struct TChannel_t *create_channel(const char *name, long capacity, size_t msg_size) {
+  char shm_name[NAME_MAX];
+  struct TChannel_t *channel;
+  struct TRing_t *ring;
+  unsigned int i, n_slots, slot_size;
+  size_t size;
+  int fd;
+
+  /* Round the capacity up to a power of two so tickets can wrap */
+  for (n_slots = 1; n_slots < capacity && n_slots <= INT_MAX / 2; n_slots *= 2);
+  slot_size = (sizeof(struct TRingSlot_t) + msg_size + CACHE_LINE - 1) & ~(CACHE_LINE - 1);
+  size = sizeof(struct TRing_t) + (size_t)n_slots * slot_size;
+  if (capacity < 1 || msg_size > UINT_MAX || size > MAX_RING_BYTES) {
+    fprintf(stderr, "Error creating ring %s: %ld messages of %zu bytes do not fit in %ld bytes.\n",
+	    name, capacity, msg_size, MAX_RING_BYTES);
+    return NULL;
+  }
+
+  get_shm_name(name, shm_name);
+  if ((fd = shm_open(shm_name, O_CREAT | O_RDWR, S_IWUSR | S_IRUSR)) == -1 ||
+      ftruncate(fd, size) == -1) {
+    fprintf(stderr, "Error creating ring %s: %s.\n", name, strerror(errno));
+    if (fd != -1) {
+      close(fd);
+    }
+    return NULL;
+  }
+  if ((channel = map_channel(name, fd, size)) == NULL) {
+    return NULL;
+  }
+
+  ring = channel->ring;
+  ring->capacity = n_slots;
+  ring->slot_size = slot_size;
+  ring->msg_size = msg_size;
+  ring->size = size;
+  ring->head = ring->tail = 0;
+  ring->puts = ring->takes = 0;
+  ring->consumers_waiting = ring->producers_waiting = 0;
+  for (i = 0; i < n_slots; i++) {
+    get_slot(ring, i)->sequence = i;
+  }
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+  return channel;
+}
+
+struct TChannel_t *open_channel(const char *name) {
+  char shm_name[NAME_MAX];
+  struct stat info;
+  int fd;
+
+  get_shm_name(name, shm_name);
+  if ((fd = shm_open(shm_name, O_RDWR, S_IWUSR | S_IRUSR)) == -1 || fstat(fd, &info) == -1) {
+    fprintf(stderr, "Error opening ring %s: %s.\n", name, strerror(errno));
+    if (fd != -1) {
+      close(fd);
+    }
+    return NULL;
+  }
+
+  return map_channel(name, fd, info.st_size);
+}
+
+void close_channel(struct TChannel_t *channel) {
+  munmap(channel->ring, channel->ring->size);
+  free(channel);
+}
+
+void remove_channel(const char *name) {
+  char shm_name[NAME_MAX];
+
+  get_shm_name(name, shm_name);
+  shm_unlink(shm_name);
+}
+
+long channel_depth(struct TChannel_t *channel) {
+  struct TRing_t *ring = channel->ring;
+  unsigned int tail;
+
+  /* Claimed slots count as queued */
+  tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+  return (int)(__atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) - tail);
+}
+
+void send_message(struct TChannel_t *channel, const void *msg, size_t size) {
+  struct TRing_t *ring = channel->ring;
+  int takes;
+
+  if (!try_put(ring, msg, size)) {
+    /* Full: announce ourselves before re-checking, then sleep until a take */
+    __atomic_add_fetch(&ring->producers_waiting, 1, __ATOMIC_SEQ_CST);
+    do {
+      takes = __atomic_load_n(&ring->takes, __ATOMIC_SEQ_CST);
+      if (try_put(ring, msg, size)) {
+	break;
+      }
+      futex_wait(&ring->takes, takes);
+    } while (TRUE);
+    __atomic_sub_fetch(&ring->producers_waiting, 1, __ATOMIC_SEQ_CST);
+  }
+
+  notify_put(ring);
+}
+
+size_t receive_message(struct TChannel_t *channel, void *msg, size_t size) {
+  struct TRing_t *ring = channel->ring;
+  size_t length;
+  int puts;
+
+  if (!try_take(ring, msg, size, &length)) {
+    /* Empty: same protocol as send_message() on the other futex word */
+    __atomic_add_fetch(&ring->consumers_waiting, 1, __ATOMIC_SEQ_CST);
+    do {
+      puts = __atomic_load_n(&ring->puts, __ATOMIC_SEQ_CST);
+      if (try_take(ring, msg, size, &length)) {
+	break;
+      }
+      futex_wait(&ring->puts, puts);
+    } while (TRUE);
+    __atomic_sub_fetch(&ring->consumers_waiting, 1, __ATOMIC_SEQ_CST);
+  }
+
+  notify_take(ring);
+
+  return length;
+}
+
+int try_send_message(struct TChannel_t *channel, const void *msg, size_t size) {
+  if (!try_put(channel->ring, msg, size)) {
+    return FALSE;
+  }
+  notify_put(channel->ring);
+
+  return TRUE;
+}
+
+int try_receive_message(struct TChannel_t *channel, void *msg, size_t size, size_t *length) {
+  if (!try_take(channel->ring, msg, size, length)) {
+    return FALSE;
+  }
+  notify_take(channel->ring);
+
+  return TRUE;
+}
+
+void wait_channels(struct TChannel_t *readable, struct TChannel_t *writable, int timeout_ms) {
+  struct TRing_t *ring;
+  int *word, *waiting, value;
+
+  if (readable != NULL) {
+    ring = readable->ring;
+    word = &ring->puts;
+    waiting = &ring->consumers_waiting;
+  }
+  else if (writable != NULL) {
+    ring = writable->ring;
+    word = &ring->takes;
+    waiting = &ring->producers_waiting;
+  }
+  else {
+    usleep(timeout_ms * 1000);
+    return;
+  }
+
+  /* Same protocol as the blocking calls, bounded by the timeout */
+  __atomic_add_fetch(waiting, 1, __ATOMIC_SEQ_CST);
+  value = __atomic_load_n(word, __ATOMIC_SEQ_CST);
+  if ((readable == NULL || channel_depth(readable) == 0) &&
+      (writable == NULL || channel_depth(writable) >= writable->ring->capacity)) {
+    futex_wait_timeout(word, value, timeout_ms);
+  }
+  __atomic_sub_fetch(waiting, 1, __ATOMIC_SEQ_CST);
+}
+
+/******************** Ring operations ********************/
+
+int try_put(struct TRing_t *ring, const void *msg, size_t size) {
+  struct TRingSlot_t *slot;
+  unsigned int ticket, sequence;
+
+  if (size > ring->msg_size) {
+    size = ring->msg_size;
+  }
+
+  ticket = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+  while (TRUE) {
+    slot = get_slot(ring, ticket);
+    sequence = __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE);
+
+    if (sequence == ticket) {
+      /* Free slot: claim it (on failure 'ticket' is reloaded) */
+      if (__atomic_compare_exchange_n(&ring->head, &ticket, ticket + 1, TRUE,
+				      __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+	break;
+      }
+    }
+    else if ((int)(sequence - ticket) < 0) {
+      /* Not taken yet since the last lap: full */
+      return FALSE;
+    }
+    else {
+      ticket = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+    }
+  }
+
+  memcpy(slot->msg, msg, size);
+  slot->length = size;
+  __atomic_store_n(&slot->sequence, ticket + 1, __ATOMIC_RELEASE);
+
+  return TRUE;
+}
+
+int try_take(struct TRing_t *ring, void *msg, size_t size, size_t *length) {
+  struct TRingSlot_t *slot;
+  unsigned int ticket, sequence;
+
+  ticket = __atomic_load_n(&ring->tail, __ATOMIC_RELAXED);
+  while (TRUE) {
+    slot = get_slot(ring, ticket);
+    sequence = __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE);
+
+    if (sequence == ticket + 1) {
+      if (__atomic_compare_exchange_n(&ring->tail, &ticket, ticket + 1, TRUE,
+				      __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+	break;
+      }
+    }
+    else if ((int)(sequence - (ticket + 1)) < 0) {
+      /* Not put yet: empty */
+      return FALSE;
+    }
+    else {
+      ticket = __atomic_load_n(&ring->tail, __ATOMIC_RELAXED);
+    }
+  }
+
+  *length = (slot->length < size) ? slot->length : size;
+  memcpy(msg, slot->msg, *length);
+  /* Free for the producer of the next lap */
+  __atomic_store_n(&slot->sequence, ticket + ring->capacity, __ATOMIC_RELEASE);
+
+  return TRUE;
+}
+
+void notify_put(struct TRing_t *ring) {
+  __atomic_add_fetch(&ring->puts, 1, __ATOMIC_SEQ_CST);
+  if (__atomic_load_n(&ring->consumers_waiting, __ATOMIC_SEQ_CST) > 0) {
+    futex_wake(&ring->puts, 1);
+  }
+}
+
+void notify_take(struct TRing_t *ring) {
+  __atomic_add_fetch(&ring->takes, 1, __ATOMIC_SEQ_CST);
+  if (__atomic_load_n(&ring->producers_waiting, __ATOMIC_SEQ_CST) > 0) {
+    futex_wake(&ring->takes, 1);
+  }
+}
+
+struct TRingSlot_t *get_slot(struct TRing_t *ring, unsigned int ticket) {
+  return (struct TRingSlot_t *)((char *)(ring + 1) + (size_t)(ticket & (ring->capacity - 1)) * ring->slot_size);
+}
+
+/******************** Auxiliar functions ********************/
+
+struct TChannel_t *map_channel(const char *name, int fd, size_t size) {
+  struct TChannel_t *channel;
+  void *ring;
+
+  ring = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (ring == MAP_FAILED) {
+    fprintf(stderr, "Error mapping ring %s: %s.\n", name, strerror(errno));
+    return NULL;
+  }
+  if ((channel = malloc(sizeof(struct TChannel_t))) == NULL) {
+    munmap(ring, size);
+    return NULL;
+  }
+  channel->ring = ring;
+
+  return channel;
+}
+
+void get_shm_name(const char *name, char *shm_name) {
+  /* Queue names start with '/' */
+  snprintf(shm_name, NAME_MAX, "%s%s", RING_SHM_PREFIX, (name[0] == '/') ? name + 1 : name);
+}
+
+int futex_wait(int *uaddr, int val) {
+  return syscall(SYS_futex, uaddr, FUTEX_WAIT, val, NULL, NULL, 0);
+}
+
+int futex_wait_timeout(int *uaddr, int val, int timeout_ms) {
+  struct timespec timeout;
+
+  /* FUTEX_WAIT takes a relative timeout */
+  timeout.tv_sec = timeout_ms / 1000;
+  timeout.tv_nsec = (timeout_ms % 1000) * 1000000L;
+
+  return syscall(SYS_futex, uaddr, FUTEX_WAIT, val, &timeout, NULL, 0);
+}
+
+int futex_wake(int *uaddr, int n) {
+  return syscall(SYS_futex, uaddr, FUTEX_WAKE, n, NULL, NULL, 0);
+}